@@ -136,6 +136,74 @@ void DrawImages(cOsd *Osd)
   Osd->Flush();
 }
 
+// --- cBenchmarkOsd --------------------------------------------------------
+
+#define BENCHMARKTIME     2000 // ms per measurement
+#define BENCHMARKSPRITES    12 // number of animated pixmaps
+
+// An OSD that is never displayed, used to measure how fast the pixmaps
+// of a true color OSD can be rendered:
+
+class cBenchmarkOsd : public cOsd {
+private:
+  cPixmap *sprites[BENCHMARKSPRITES];
+  cPoint speed[BENCHMARKSPRITES];
+public:
+  cBenchmarkOsd(int Width, int Height);
+  int RenderFrame(void);
+      ///< Moves all sprites and renders the dirty parts of the OSD.
+      ///< Returns the number of rendered pixels.
+  };
+
+cBenchmarkOsd::cBenchmarkOsd(int Width, int Height)
+:cOsd(0, 0, OSD_LEVEL_SUBTITLES + 1) // never the active OSD
+{
+  tArea Area = { 0, 0, Width - 1, Height - 1, 32 };
+  SetAreas(&Area, 1);
+  if (cPixmap *Background = CreatePixmap(0, cRect(0, 0, Width, Height))) {
+     for (int y = 0; y < Height; y += 8)
+         Background->DrawRectangle(cRect(0, y, Width, 8), 0xFF000000 | (y * 255 / Height) << 8 | (255 - y * 255 / Height));
+     }
+  if (cPixmap *Overlay = CreatePixmap(1, cRect(0, 0, Width, Height))) {
+     Overlay->Clear();
+     Overlay->DrawRectangle(cRect(Width / 20, Height / 20, Width * 9 / 10, Height / 8), 0xC0202020);
+     Overlay->DrawRectangle(cRect(Width / 20, Height * 7 / 10, Width * 9 / 10, Height / 4), 0xC0202020);
+     }
+  for (int i = 0; i < BENCHMARKSPRITES; i++) {
+      int w = Width / 5;
+      int h = Height / 5;
+      sprites[i] = CreatePixmap(2 + i % (MAXPIXMAPLAYERS - 2), cRect(rand() % (Width - w), rand() % (Height - h), w, h));
+      if (sprites[i]) {
+         sprites[i]->Clear();
+         sprites[i]->DrawEllipse(cRect(0, 0, w, h), 0x80000000 | (rand() & 0x00FFFFFF));
+         sprites[i]->DrawEllipse(cRect(w / 4, h / 4, w / 2, h / 2), 0xFF000000 | (rand() & 0x00FFFFFF));
+         }
+      speed[i].Set(rand() % 21 - 10, rand() % 21 - 10);
+      }
+}
+
+int cBenchmarkOsd::RenderFrame(void)
+{
+  LOCK_PIXMAPS;
+  for (int i = 0; i < BENCHMARKSPRITES; i++) {
+      if (sprites[i]) {
+         cRect r = sprites[i]->ViewPort();
+         if (r.Left() + speed[i].X() < 0 || r.Right() + speed[i].X() >= Width())
+            speed[i].SetX(-speed[i].X());
+         if (r.Top() + speed[i].Y() < 0 || r.Bottom() + speed[i].Y() >= Height())
+            speed[i].SetY(-speed[i].Y());
+         r.Shift(speed[i]);
+         sprites[i]->SetViewPort(r);
+         }
+      }
+  int Pixels = 0;
+  while (cPixmap *Pixmap = RenderPixmaps()) {
+        Pixels += Pixmap->ViewPort().Width() * Pixmap->ViewPort().Height();
+        DestroyPixmap(Pixmap);
+        }
+  return Pixels;
+}
+
 // --- cLineGame -------------------------------------------------------------
 
 class cLineGame : public cOsdObject {
@@ -224,7 +292,9 @@ private:
   bool clockwise;
   cPixmap *destroyablePixmap;
   cPixmap *toggleablePixmap;
+  bool benchmark;
   bool SetArea(void);
+  void Benchmark(void);
   virtual void Action(void);
   cPixmap *CreateTextPixmap(const char *s, int Line, int Layer, tColor ColorFg, tColor ColorBg, const cFont *Font);
 public:
@@ -240,6 +310,7 @@ cTrueColorDemo::cTrueColorDemo(void)
   clockwise = true;
   destroyablePixmap = NULL;
   toggleablePixmap = NULL;
+  benchmark = false;
 }
 
 cTrueColorDemo::~cTrueColorDemo()
@@ -261,8 +332,52 @@ cPixmap *cTrueColorDemo::CreateTextPixmap(const char *s, int Line, int Layer, tC
   return Pixmap;
 }
 
+void cTrueColorDemo::Benchmark(void)
+{
+  static const cSize Sizes[] = { cSize(1280, 720), cSize(1920, 1080), cSize(3840, 2160) };
+  static const int Threads[] = { 1, 2, 4 };
+  const cFont *Font = cFont::GetFont(fontOsd);
+  int Line = Font->Height();
+  int OldRenderThreads = Setup.OSDRenderThreads;
+  cPixmap::Lock();
+  osd->DrawRectangle(0, 0, osd->Width() - 1, osd->Height() - 1, clrGray50);
+  osd->DrawText(Line, Line, "OSD rendering benchmark (frames per second):", clrWhite, clrGray50, Font);
+  osd->Flush();
+  cPixmap::Unlock();
+  int y = 2 * Line;
+  for (unsigned int s = 0; s < sizeof(Sizes) / sizeof(Sizes[0]) && Running(); s++) {
+      cString Result = cString::sprintf("%dx%d:", Sizes[s].Width(), Sizes[s].Height());
+      for (unsigned int t = 0; t < sizeof(Threads) / sizeof(Threads[0]) && Running(); t++) {
+          Setup.OSDRenderThreads = Threads[t];
+          cBenchmarkOsd *BenchmarkOsd = new cBenchmarkOsd(Sizes[s].Width(), Sizes[s].Height());
+          BenchmarkOsd->RenderFrame(); // the initial full frame isn't counted
+          int Frames = 0;
+          int64_t Pixels = 0;
+          cTimeMs Timer;
+          while (Timer.Elapsed() < BENCHMARKTIME && Running()) {
+                Pixels += BenchmarkOsd->RenderFrame();
+                Frames++;
+                }
+          int Elapsed = max(1, int(Timer.Elapsed()));
+          delete BenchmarkOsd;
+          Result = cString::sprintf("%s   %d thread%s: %.1f fps (%d MPixel/s)", *Result, Threads[t], Threads[t] > 1 ? "s" : "", Frames * 1000.0 / Elapsed, int(Pixels / 1000 / Elapsed));
+          }
+      isyslog("osddemo: %s", *Result);
+      cPixmap::Lock();
+      osd->DrawText(Line, y, Result, clrWhite, clrGray50, Font);
+      osd->Flush();
+      cPixmap::Unlock();
+      y += Line;
+      }
+  Setup.OSDRenderThreads = OldRenderThreads;
+}
+
 void cTrueColorDemo::Action(void)
 {
+  if (benchmark) {
+     Benchmark();
+     return;
+     }
   cPixmap *FadeInPixmap = NULL;
   cPixmap *FadeOutPixmap = NULL;
   cPixmap *MovePixmap = NULL;
@@ -590,6 +705,11 @@ eOSState cTrueColorDemo::ProcessKey(eKeys Key)
                      SetArea();
                      DrawImages(osd);
                      break;
+       case k4:      Cancel(3);
+                     SetArea();
+                     benchmark = true;
+                     Start();
+                     break;
        case kBack:
        case kOk:     return osEnd;
        default: return state;
@@ -53,6 +53,21 @@ tChannelID &tChannelID::ClrPolarization(void)
 
 // --- cChannel --------------------------------------------------------------
 
+static cMutex ChannelIdMutex;
+static int ChannelIdChanges = 0;
+
+void cChannel::IdChanged(void)
+{
+  cMutexLock MutexLock(&ChannelIdMutex);
+  ChannelIdChanges++;
+}
+
+int cChannel::IdChanges(void)
+{
+  cMutexLock MutexLock(&ChannelIdMutex);
+  return ChannelIdChanges;
+}
+
 cChannel::cChannel(void)
 {
   name = strdup("");
@@ -101,6 +116,7 @@ cChannel& cChannel::operator= (const cChannel &Channel)
   nameSourceMode = 0;
   shortNameSource = NULL;
   parameters = Channel.parameters;
+  IdChanged();
   return *this;
 }
 
@@ -170,6 +186,7 @@ void cChannel::CopyTransponderData(const cChannel *Channel)
      source       = Channel->source;
      srate        = Channel->srate;
      parameters   = Channel->parameters;
+     IdChanged();
      }
 }
 
@@ -198,6 +215,7 @@ bool cChannel::SetTransponderData(int Source, int Frequency, int Srate, const ch
      srate = Srate;
      parameters = Parameters;
      schedule = NULL;
+     IdChanged();
      nameSource = NULL;
      nameSourceMode = 0;
      shortNameSource = NULL;
@@ -218,6 +236,7 @@ bool cChannel::SetSource(int Source)
         modification |= CHANNELMOD_TRANSP;
         }
      source = Source;
+     IdChanged();
      return true;
      }
   return false;
@@ -238,6 +257,7 @@ bool cChannel::SetId(cChannels *Channels, int Nid, int Tid, int Sid, int Rid)
      if (Channels)
         Channels->HashChannel(this);
      schedule = NULL;
+     IdChanged();
      return true;
      }
   return false;
@@ -132,6 +132,7 @@ private:
   cLinkChannels *linkChannels;
   cChannel *refChannel;
   cString TransponderDataToString(void) const;
+  static void IdChanged(void);
 public:
   cChannel(void);
   cChannel(const cChannel &Channel);
@@ -147,6 +148,7 @@ public:
   int Frequency(void) const { return frequency; } ///< Returns the actual frequency, as given in 'channels.conf'
   int Transponder(void) const;                    ///< Returns the transponder frequency in MHz, plus the polarization in case of sat
   static int Transponder(int Frequency, char Polarization); ///< builds the transponder from the given Frequency and Polarization
+  static int IdChanges(void);                     ///< Returns a counter that is incremented whenever the channel ID of any channel may have changed
   int Source(void) const { return source; }
   int Srate(void) const { return srate; }
   int Vpid(void) const { return vpid; }
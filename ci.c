@@ -2538,6 +2538,12 @@ int cCamSlot::MtdPutData(uchar *Data, int Count)
   return mtdHandler->Put(Data, Count);
 }
 
+cString cCamSlot::MtdStatistics(void)
+{
+  cMutexLock MutexLock(&mutex);
+  return mtdHandler ? mtdHandler->Statistics() : cString("");
+}
+
 const int *cCamSlot::GetCaSystemIds(void)
 {
   cMutexLock MutexLock(&mutex);
@@ -286,6 +286,10 @@ public:
        ///< Returns true if this CAM supports MTD ("Multi Transponder Decryption").
   bool MtdActive(void) { return mtdHandler != NULL; }
        ///< Returns true if MTD is currently active.
+  cString MtdStatistics(void);
+       ///< Returns the throughput and buffer overflows of the individual MTD CAM
+       ///< slots that are using this CAM (see cMtdHandler::Statistics()), or an
+       ///< empty string if MTD is not active.
 public:
   cCamSlot(cCiAdapter *CiAdapter, bool WantsTsData = false, cCamSlot *MasterSlot = NULL);
        ///< Creates a new CAM slot for the given CiAdapter.
@@ -22,13 +22,13 @@
 
 // VDR's own version number:
 
-#define VDRVERSION  "2.3.8"
-#define VDRVERSNUM   20308  // Version * 10000 + Major * 100 + Minor
+#define VDRVERSION  "2.3.9"
+#define VDRVERSNUM   20309  // Version * 10000 + Major * 100 + Minor
 
 // The plugin API's version number:
 
-#define APIVERSION  "2.3.8"
-#define APIVERSNUM   20308  // Version * 10000 + Major * 100 + Minor
+#define APIVERSION  "2.3.9"
+#define APIVERSNUM   20309  // Version * 10000 + Major * 100 + Minor
 
 // When loading plugins, VDR searches them by their APIVERSION, which
 // may be smaller than VDRVERSION in case there have been no changes to
@@ -287,6 +287,7 @@ public:
   int EPGScanTimeout;
   int EPGBugfixLevel;
   int EPGLinger;
+  int EPGBinaryData;
   int SVDRPTimeout;
   int SVDRPPeering;
   char SVDRPHostName[HOST_NAME_MAX];
@@ -320,6 +321,7 @@ public:
   int OSDMessageTime;
   int UseSmallFont;
   int AntiAlias;
+  int OSDRenderThreads;
   char FontOsd[MAXFONTNAME];
   char FontSml[MAXFONTNAME];
   char FontFix[MAXFONTNAME];
@@ -332,6 +334,7 @@ public:
   int MaxVideoFileSize;
   int SplitEditedFiles;
   int DelTimeshiftRec;
+  int RecordingScanThreads;
   int MinEventTimeout, MinUserInactivity;
   time_t NextWakeupTime;
   int MultiSpeedMode;
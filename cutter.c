@@ -220,6 +220,8 @@ void cMpeg2Fixer::AdjTref(int TrefOffset)
 
 // --- cCuttingThread --------------------------------------------------------
 
+#define MAXCOPYRANGESIZE MEGABYTE(64) // max. number of bytes copied with one call to CopyRange()
+
 class cCuttingThread : public cThread {
 private:
   const char *error;
@@ -243,6 +245,7 @@ private:
   uchar counter[MAXPID]; // the TS continuity counter for each PID
   bool keepPkt[MAXPID];  // flag for each PID to keep packets, for dangling packet stripping
   int numIFrames;        // number of I-frames without pending packets
+  bool copyRange;        // unmodified frames can be copied with cUnbufferedFile::CopyRange()
   cPatPmtParser patPmtParser;
   bool Throttled(void);
   bool SwitchFile(bool Force = false);
@@ -253,6 +256,11 @@ private:
        // payloads that started before Index, or have a PTS that is before lastVidPts,
        // and add them to the end of the given Data.
   bool FixFrame(uchar *Data, int &Length, bool Independent, int Index, bool CutIn, bool CutOut);
+  int CopyFrames(int Index, int LimitIndex);
+       // Copies a run of frames from Index up to (but not including) LimitIndex, which
+       // don't need to be modified, directly from the input to the output file, and
+       // writes their index entries. Returns the number of frames copied, which may be
+       // 0 if the frame at Index can't be copied that way, or -1 in case of an error.
   bool ProcessSequence(int LastEndIndex, int BeginIndex, int EndIndex, int NextBeginIndex);
 protected:
   virtual void Action(void);
@@ -283,6 +291,7 @@ cCuttingThread::cCuttingThread(const char *FromFileName, const char *ToFileName)
   tRefOffset = 0;
   memset(counter, 0x00, sizeof(counter));
   numIFrames = 0;
+  copyRange = true;
   if (fromMarks.Load(FromFileName, framesPerSecond, isPesRecording) && fromMarks.Count()) {
      numSequences = fromMarks.GetNumSequences();
      if (numSequences > 0) {
@@ -541,11 +550,81 @@ bool cCuttingThread::FixFrame(uchar *Data, int &Length, bool Independent, int In
   return DeletedFrame;
 }
 
+int cCuttingThread::CopyFrames(int Index, int LimitIndex)
+{
+  // Determine the run of frames that can be copied in one go:
+  uint16_t FileNumber;
+  off_t FileOffset;
+  bool Independent;
+  int Length;
+  if (!fromIndex->Get(Index, &FileNumber, &FileOffset, &Independent, &Length) || Length <= 0)
+     return 0;
+  off_t Size = 0;
+  int i = Index;
+  for (;;) {
+      Size += Length;
+      if (++i >= LimitIndex || Size >= MAXCOPYRANGESIZE)
+         break;
+      uint16_t fn;
+      off_t fo;
+      bool ind;
+      if (!fromIndex->Get(i, &fn, &fo, &ind, &Length) || fn != FileNumber || Length <= 0)
+         break;
+      if (ind && fileSize + Size > maxVideoFileSize)
+         break; // the output file needs to be switched at this frame
+      }
+  // Every file shall start with an independent frame:
+  if (Independent) {
+     if (!SwitchFile())
+        return -1;
+     }
+  fromFile = fromFileName->SetOffset(FileNumber, FileOffset);
+  if (!fromFile) {
+     error = "fromFile";
+     return -1;
+     }
+  AssertFreeDiskSpace(-1);
+  ssize_t Copied = toFile->CopyRange(fromFile, FileOffset, Size);
+  if (Copied != Size) {
+     if (Copied < 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+        dsyslog("can't copy ranges of %s (%s) - falling back to reading and writing", fromFileName->Name(), strerror(errno));
+        copyRange = false;
+        return 0;
+        }
+     LOG_ERROR_STR(fromFileName->Name());
+     error = "CopyRange";
+     return -1;
+     }
+  // Write the index entries:
+  for (int n = Index; n < i; n++) {
+      fromIndex->Get(n, &FileNumber, &FileOffset, &Independent, &Length);
+      if (!toIndex->Write(Independent, toFileName->Number(), fileSize)) {
+         error = "toIndex";
+         return -1;
+         }
+      fileSize += Length;
+      }
+  return i - Index;
+}
+
 bool cCuttingThread::ProcessSequence(int LastEndIndex, int BeginIndex, int EndIndex, int NextBeginIndex)
 {
   // Check for seamless connections:
   bool SeamlessBegin = LastEndIndex >= 0 && FramesAreEqual(LastEndIndex, BeginIndex);
   bool SeamlessEnd = NextBeginIndex >= 0 && FramesAreEqual(EndIndex, NextBeginIndex);
+  // Determine the frames that don't need to be modified and can be copied as they are.
+  // In PES recordings these are all frames except for the first one. In TS recordings
+  // FixFrame() modifies all frames of any sequence after the first one, and needs to
+  // see all frames after the last independent one at the end of the sequence to
+  // get the pending packets right, so only the frames in the middle of a sequence
+  // can be copied if there is only one sequence:
+  int CopyLimit = EndIndex;
+  if (!isPesRecording) {
+     if (numSequences == 1 && !SeamlessEnd)
+        CopyLimit = fromIndex->GetNextIFrame(EndIndex, false);
+     else
+        CopyLimit = -1;
+     }
   // Process all frames from BeginIndex (included) to EndIndex (excluded):
   cHeapBuffer Buffer(MAXFRAMESIZE);
   if (!Buffer) {
@@ -553,6 +632,15 @@ bool cCuttingThread::ProcessSequence(int LastEndIndex, int BeginIndex, int EndIn
      return false;
      }
   for (int Index = BeginIndex; Running() && Index < EndIndex; Index++) {
+      if (copyRange && Index < CopyLimit && Index > BeginIndex && (isPesRecording || numIFrames >= 2)) { // numIFrames < 2 means FixFrame() may still strip dangling packets
+         int n = CopyFrames(Index, CopyLimit);
+         if (n < 0)
+            return false;
+         if (n > 0) {
+            Index += n - 1;
+            continue;
+            }
+         }
       bool Independent;
       int Length;
       if (LoadFrame(Index, Buffer, Independent, Length)) {
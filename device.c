@@ -105,6 +105,7 @@ cDevice::cDevice(void)
 
   for (int i = 0; i < MAXRECEIVERS; i++)
       receiver[i] = NULL;
+  memset(receiverPids, 0, sizeof(receiverPids));
 
   if (numDevices < MAXDEVICES)
      device[numDevices++] = this;
@@ -1575,11 +1576,20 @@ int cDevice::PlayTs(const uchar *Data, int Length, bool VideoOnly)
      return Length;
      }
   else {
+     tTsHeader Headers[TS_SCAN_PACKETS];
+     int NumHeaders = 0;
+     int Header = 0;
      while (Length >= TS_SIZE) {
-           if (int Skipped = TS_SYNC(Data, Length))
-              return Played + Skipped;
-           int Pid = TsPid(Data);
-           if (TsHasPayload(Data)) { // silently ignore TS packets w/o payload
+           if (Header >= NumHeaders) {
+              // Get the headers of the next block of TS packets:
+              if (int Skipped = TS_SYNC(Data, Length))
+                 return Played + Skipped;
+              NumHeaders = TsScanHeaders(Data, Length, Headers, TS_SCAN_PACKETS);
+              Header = 0;
+              }
+           const tTsHeader &h = Headers[Header++];
+           int Pid = h.pid;
+           if (h.flags & TSH_PAYLOAD) { // silently ignore TS packets w/o payload
               int PayloadOffset = TsPayloadOffset(Data);
               if (PayloadOffset < TS_SIZE) {
                  if (Pid == PATPID)
@@ -1662,61 +1672,81 @@ void cDevice::Action(void)
   if (Running() && OpenDvr()) {
      while (Running()) {
            // Read data from the DVR device:
-           uchar *b = NULL;
-           if (GetTSPacket(b)) {
-              if (b) {
-                 // Distribute the packet to all attached receivers:
+           uchar *Data = NULL;
+           int Count = 0;
+           if (GetTSPackets(Data, Count)) {
+              if (Data) {
+                 // Distribute the packets to all attached receivers:
                  Lock();
                  cCamSlot *cs = CamSlot();
-                 if (cs)
-                    cs->TsPostProcess(b);
-                 int Pid = TsPid(b);
-                 bool IsScrambled = TsIsScrambled(b);
+                 // Consecutive packets for the same receiver are collected and delivered in one call:
+                 const uchar *Run[MAXRECEIVERS] = { NULL };
+                 int RunLength[MAXRECEIVERS] = { 0 };
+                 for (uchar *b = Data; b < Data + Count; b += TS_SIZE) {
+                     if (cs)
+                        cs->TsPostProcess(b);
+                     int Pid = TsPid(b);
+                     bool IsScrambled = TsIsScrambled(b);
+                     uint32_t Wanted = receiverPids[Pid];
+                     for (int i = 0; Wanted; i++, Wanted >>= 1) {
+                         cReceiver *Receiver = receiver[i];
+                         if ((Wanted & 1) && Receiver) {
+                            if (RunLength[i] && Run[i] + RunLength[i] != b) {
+                               Receiver->ReceivePackets(Run[i], RunLength[i]);
+                               RunLength[i] = 0;
+                               }
+                            if (!RunLength[i])
+                               Run[i] = b;
+                            RunLength[i] += TS_SIZE;
+                            // Check whether the TS packet is scrambled:
+                            if (Receiver->startScrambleDetection) {
+                               if (cs) {
+                                  int CamSlotNumber = cs->MasterSlotNumber();
+                                  if (Receiver->lastScrambledPacket < Receiver->startScrambleDetection)
+                                     Receiver->lastScrambledPacket = Receiver->startScrambleDetection;
+                                  time_t Now = time(NULL);
+                                  if (IsScrambled) {
+                                     Receiver->lastScrambledPacket = Now;
+                                     if (Now - Receiver->startScrambleDetection > Receiver->scramblingTimeout) {
+                                        if (!cs->IsActivating() || Receiver->Priority() >= LIVEPRIORITY) {
+                                           if (Receiver->ChannelID().Valid()) {
+                                              dsyslog("CAM %d: won't decrypt channel %s, detaching receiver", CamSlotNumber, *Receiver->ChannelID().ToString());
+                                              ChannelCamRelations.SetChecked(Receiver->ChannelID(), CamSlotNumber);
+                                              }
+                                           Receiver->ReceivePackets(Run[i], RunLength[i]);
+                                           RunLength[i] = 0;
+                                           Detach(Receiver);
+                                           continue;
+                                           }
+                                        }
+                                     }
+                                  else if (Now - Receiver->lastScrambledPacket > TS_SCRAMBLING_TIME_OK) {
+                                     if (Receiver->ChannelID().Valid()) {
+                                        dsyslog("CAM %d: decrypts channel %s", CamSlotNumber, *Receiver->ChannelID().ToString());
+                                        ChannelCamRelations.SetDecrypt(Receiver->ChannelID(), CamSlotNumber);
+                                        }
+                                     Receiver->startScrambleDetection = 0;
+                                     }
+                                  }
+                               }
+                            // Inject EIT event to avoid the CAMs parental rating prompt:
+                            if (Receiver->startEitInjection) {
+                               time_t Now = time(NULL);
+                               if (cCamSlot *cs = CamSlot()) {
+                                  if (Now != Receiver->lastEitInjection) { // once per second
+                                     cs->InjectEit(Receiver->ChannelID().Sid());
+                                     Receiver->lastEitInjection = Now;
+                                     }
+                                  }
+                               if (Now - Receiver->startEitInjection > EIT_INJECTION_TIME)
+                                  Receiver->startEitInjection = 0;
+                               }
+                            }
+                         }
+                     }
                  for (int i = 0; i < MAXRECEIVERS; i++) {
-                     cReceiver *Receiver = receiver[i];
-                     if (Receiver && Receiver->WantsPid(Pid)) {
-                        Receiver->Receive(b, TS_SIZE);
-                        // Check whether the TS packet is scrambled:
-                        if (Receiver->startScrambleDetection) {
-                           if (cs) {
-                              int CamSlotNumber = cs->MasterSlotNumber();
-                              if (Receiver->lastScrambledPacket < Receiver->startScrambleDetection)
-                                 Receiver->lastScrambledPacket = Receiver->startScrambleDetection;
-                              time_t Now = time(NULL);
-                              if (IsScrambled) {
-                                 Receiver->lastScrambledPacket = Now;
-                                 if (Now - Receiver->startScrambleDetection > Receiver->scramblingTimeout) {
-                                    if (!cs->IsActivating() || Receiver->Priority() >= LIVEPRIORITY) {
-                                       if (Receiver->ChannelID().Valid()) {
-                                          dsyslog("CAM %d: won't decrypt channel %s, detaching receiver", CamSlotNumber, *Receiver->ChannelID().ToString());
-                                          ChannelCamRelations.SetChecked(Receiver->ChannelID(), CamSlotNumber);
-                                          }
-                                       Detach(Receiver);
-                                       }
-                                    }
-                                 }
-                              else if (Now - Receiver->lastScrambledPacket > TS_SCRAMBLING_TIME_OK) {
-                                 if (Receiver->ChannelID().Valid()) {
-                                    dsyslog("CAM %d: decrypts channel %s", CamSlotNumber, *Receiver->ChannelID().ToString());
-                                    ChannelCamRelations.SetDecrypt(Receiver->ChannelID(), CamSlotNumber);
-                                    }
-                                 Receiver->startScrambleDetection = 0;
-                                 }
-                              }
-                           }
-                        // Inject EIT event to avoid the CAMs parental rating prompt:
-                        if (Receiver->startEitInjection) {
-                           time_t Now = time(NULL);
-                           if (cCamSlot *cs = CamSlot()) {
-                              if (Now != Receiver->lastEitInjection) { // once per second
-                                 cs->InjectEit(Receiver->ChannelID().Sid());
-                                 Receiver->lastEitInjection = Now;
-                                 }
-                              }
-                           if (Now - Receiver->startEitInjection > EIT_INJECTION_TIME)
-                              Receiver->startEitInjection = 0;
-                           }
-                        }
+                     if (RunLength[i] && receiver[i])
+                        receiver[i]->ReceivePackets(Run[i], RunLength[i]);
                      }
                  Unlock();
                  }
@@ -1742,6 +1772,16 @@ bool cDevice::GetTSPacket(uchar *&Data)
   return false;
 }
 
+bool cDevice::GetTSPackets(uchar *&Data, int &Count)
+{
+  if (GetTSPacket(Data)) {
+     Count = Data ? TS_SIZE : 0;
+     return true;
+     }
+  Count = 0;
+  return false;
+}
+
 bool cDevice::AttachReceiver(cReceiver *Receiver)
 {
   if (!Receiver)
@@ -1771,6 +1811,8 @@ bool cDevice::AttachReceiver(cReceiver *Receiver)
          Lock();
          Receiver->device = this;
          receiver[i] = Receiver;
+         for (int n = 0; n < Receiver->numPids; n++)
+             receiverPids[Receiver->pids[n]] |= 1 << i;
          Unlock();
          if (camSlot && Receiver->priority > MINPRIORITY) { // priority check to avoid an infinite loop with the CAM slot's caPidReceiver
             camSlot->StartDecrypting();
@@ -1807,6 +1849,8 @@ void cDevice::Detach(cReceiver *Receiver)
          Lock();
          receiver[i] = NULL;
          Receiver->device = NULL;
+         for (int n = 0; n < Receiver->numPids; n++)
+             receiverPids[Receiver->pids[n]] &= ~(1 << i);
          Unlock();
          Receiver->Activate(false);
          for (int n = 0; n < Receiver->numPids; n++)
@@ -1838,6 +1882,23 @@ void cDevice::DetachAll(int Pid)
      }
 }
 
+void cDevice::SetReceiverPid(const cReceiver *Receiver, int Pid, bool On)
+{
+  if (Pid < 0 || Pid >= MAXPID)
+     return;
+  Lock(); // receiver[] is only modified under this lock, and Receive() may call this function
+  for (int i = 0; i < MAXRECEIVERS; i++) {
+      if (receiver[i] == Receiver) {
+         if (On)
+            receiverPids[Pid] |= 1 << i;
+         else
+            receiverPids[Pid] &= ~(1 << i);
+         break;
+         }
+      }
+  Unlock();
+}
+
 void cDevice::DetachAllReceivers(void)
 {
   cMutexLock MutexLock(&mutexReceiver);
@@ -1847,13 +1908,21 @@ void cDevice::DetachAllReceivers(void)
 
 // --- cTSBuffer -------------------------------------------------------------
 
+#define TSBUFFERCHUNKSIZE (TS_SIZE * 100) // the amount of data (in bytes) we want to get with each read()
+#define TSBUFFERMAXDELAY  10 // ms to wait at most for more data after a short read()
+#define TSBUFFERSTATSDELTA 600 // seconds between reports of the read statistics
+
 cTSBuffer::cTSBuffer(int File, int Size, int CardIndex)
 {
   SetDescription("device %d TS buffer", CardIndex);
   f = File;
   cardIndex = CardIndex;
   delivered = 0;
-  ringBuffer = new cRingBufferLinear(Size, TS_SIZE, true, "TS");
+  wakeups = 0;
+  reads = 0;
+  readBytes = 0;
+  overflows = 0;
+  ringBuffer = new cRingBufferLinear(Size, TS_SIZE, true, "TS", true);
   ringBuffer->SetTimeouts(100, 100);
   ringBuffer->SetIoThrottle();
   Start();
@@ -1863,6 +1932,16 @@ cTSBuffer::~cTSBuffer()
 {
   Cancel(3);
   delete ringBuffer;
+  ReportStatistics();
+}
+
+void cTSBuffer::ReportStatistics(void)
+{
+  dsyslog("TS buffer on device %d: %d wakeups, %d reads (avg. %d bytes), %d overflows", cardIndex, wakeups, reads, reads ? int(readBytes / reads) : 0, overflows);
+  wakeups = 0;
+  reads = 0;
+  readBytes = 0;
+  overflows = 0;
 }
 
 void cTSBuffer::Action(void)
@@ -1870,19 +1949,46 @@ void cTSBuffer::Action(void)
   if (ringBuffer) {
      bool firstRead = true;
      cPoller Poller(f);
+     cTimeMs LastRead;
+     cTimeMs LastReport;
+     double BytesPerMs = 0; // the smoothed data rate
      while (Running()) {
+           if (LastReport.Elapsed() > TSBUFFERSTATSDELTA * 1000) {
+              ReportStatistics();
+              LastReport.Set();
+              }
            if (firstRead || Poller.Poll(100)) {
               firstRead = false;
+              wakeups++;
               int r = ringBuffer->Read(f);
+              int Delay = TSBUFFERMAXDELAY;
               if (r < 0 && FATALERRNO) {
-                 if (errno == EOVERFLOW)
+                 if (errno == EOVERFLOW) {
+                    overflows++;
                     esyslog("ERROR: driver buffer overflow on device %d", cardIndex);
+                    }
                  else {
                     LOG_ERROR;
                     break;
                     }
                  }
-              cCondWait::SleepMs(10); // avoids small chunks of data, which cause high CPU usage, esp. on ARM CPUs
+              else if (r > 0) {
+                 reads++;
+                 readBytes += r;
+                 // Measure the data rate, based on the data that has arrived since the last read():
+                 if (uint64_t Elapsed = LastRead.Elapsed()) {
+                    double Rate = double(r) / Elapsed;
+                    BytesPerMs = BytesPerMs > 0 ? (7 * BytesPerMs + Rate) / 8 : Rate;
+                    }
+                 LastRead.Set();
+                 // Wait only as long as it takes to fill a whole chunk at the current data rate:
+                 if (r >= TSBUFFERCHUNKSIZE)
+                    Delay = 0;
+                 else if (BytesPerMs > 0)
+                    Delay = max(1, int(min(double(Delay), (TSBUFFERCHUNKSIZE - r) / BytesPerMs)));
+                 }
+              if (Delay > 0)
+                 cCondWait::SleepMs(Delay); // avoids small chunks of data, which cause high CPU usage, esp. on ARM CPUs
               }
            }
      }
@@ -1900,12 +2006,8 @@ uchar *cTSBuffer::Get(int *Available, bool CheckAvailable)
   uchar *p = ringBuffer->Get(Count);
   if (p && Count >= TS_SIZE) {
      if (*p != TS_SYNC_BYTE) {
-        for (int i = 1; i < Count; i++) {
-            if (p[i] == TS_SYNC_BYTE) {
-               Count = i;
-               break;
-               }
-            }
+        if (const uchar *s = (const uchar *)memchr(p + 1, TS_SYNC_BYTE, Count - 1))
+           Count = s - p;
         ringBuffer->Del(Count);
         esyslog("ERROR: skipped %d bytes to sync on TS packet on device %d", Count, cardIndex);
         return NULL;
@@ -1918,6 +2020,26 @@ uchar *cTSBuffer::Get(int *Available, bool CheckAvailable)
   return NULL;
 }
 
+uchar *cTSBuffer::GetPackets(int &Count, int MaxPackets, bool CheckAvailable)
+{
+  int Available = 0;
+  uchar *p = Get(&Available, CheckAvailable);
+  Count = 0;
+  if (p) {
+     int Max = min(Available, MaxPackets * TS_SIZE);
+     // The run ends with the first packet that is out of sync:
+     tTsHeader Headers[TS_SCAN_PACKETS];
+     Count = 0;
+     while (int n = TsScanHeaders(p + Count, Max - Count, Headers, TS_SCAN_PACKETS)) {
+           Count += n * TS_SIZE;
+           if (n < TS_SCAN_PACKETS)
+              break;
+           }
+     delivered = Count;
+     }
+  return p;
+}
+
 void cTSBuffer::Skip(int Count)
 {
   delivered = Count;
@@ -29,6 +29,11 @@
 #define MAXDEVICES         16 // the maximum number of devices in the system
 #define MAXPIDHANDLES      64 // the maximum number of different PIDs per device
 #define MAXRECEIVERS       16 // the maximum number of receivers per device
+#define MAXTSPACKETSPERGET 128 // the maximum number of TS packets delivered at once by GetTSPackets()
+
+#if MAXRECEIVERS > 32
+#error "MAXRECEIVERS exceeds the number of bits in cDevice::receiverPids"
+#endif
 #define MAXVOLUME         255
 #define VOLUMEDELTA       (MAXVOLUME / Setup.VolumeSteps) // used to increase/decrease the volume
 #define MAXOCCUPIEDTIMEOUT 99 // max. time (in seconds) a device may be occupied
@@ -831,6 +836,10 @@ public:
 private:
   mutable cMutex mutexReceiver;
   cReceiver *receiver[MAXRECEIVERS];
+  uint32_t receiverPids[MAXPID]; // bit i is set if receiver[i] wants the PID used as the index
+  void SetReceiverPid(const cReceiver *Receiver, int Pid, bool On);
+       ///< Marks the given Pid as wanted (On == true) or no longer wanted by the
+       ///< given Receiver in the PID dispatch table.
 public:
   int Priority(void) const;
       ///< Returns the priority of the current receiving session (-MAXPRIORITY..MAXPRIORITY),
@@ -848,6 +857,17 @@ protected:
       ///< new data available, Data will be set to NULL. The function returns
       ///< false in case of a non recoverable error, otherwise it returns true,
       ///< even if Data is NULL.
+  virtual bool GetTSPackets(uchar *&Data, int &Count);
+      ///< Gets a contiguous run of TS packets from the DVR of this device and
+      ///< returns a pointer to the first one in Data, and the total number of
+      ///< bytes in Count. Count is always a multiple of TS_SIZE and will not exceed
+      ///< MAXTSPACKETSPERGET * TS_SIZE. Each of the packets starts with a
+      ///< TS_SYNC_BYTE. If there is currently no new data available, Data will be
+      ///< set to NULL and Count to 0. The function returns false in case of a non
+      ///< recoverable error, otherwise it returns true, even if Data is NULL.
+      ///< The default implementation simply calls GetTSPacket(), so a derived
+      ///< device only needs to implement this function if it can deliver more than
+      ///< one TS packet at a time.
 public:
   bool Receiving(bool Dummy = false) const;
        ///< Returns true if we are currently receiving. The parameter has no meaning (for backwards compatibility only).
@@ -874,7 +894,12 @@ private:
   int f;
   int cardIndex;
   int delivered;
+  int wakeups;
+  int reads;
+  int64_t readBytes;
+  int overflows;
   cRingBufferLinear *ringBuffer;
+  void ReportStatistics(void);
   virtual void Action(void);
 public:
   cTSBuffer(int File, int Size, int CardIndex);
@@ -890,6 +915,13 @@ public:
      ///< at least TS_SIZE bytes before trying to get any data from it. Otherwise, if
      ///< the buffer is empty, this function will wait a little while for the buffer
      ///< to be filled again.
+  uchar *GetPackets(int &Count, int MaxPackets, bool CheckAvailable = false);
+     ///< Works like Get(), but returns a pointer to a contiguous run of up to
+     ///< MaxPackets TS packets, each of which starts with a TS_SYNC_BYTE. The total
+     ///< number of bytes in this run is returned in Count, which is always a multiple
+     ///< of TS_SIZE. The next call to Get() or GetPackets() will continue right after
+     ///< the returned run, unless Skip() is called in between. If no data is
+     ///< available, NULL is returned and Count is set to 0.
   void Skip(int Count);
      ///< If after a call to Get() more or less than TS_SIZE of the available data
      ///< has been processed, a call to Skip() with the number of processed bytes
@@ -1943,6 +1943,21 @@ bool cDvbDevice::GetTSPacket(uchar *&Data)
   return false;
 }
 
+bool cDvbDevice::GetTSPackets(uchar *&Data, int &Count)
+{
+  if (tsBuffer) {
+     if (cCamSlot *cs = CamSlot()) {
+        if (cs->WantsTsData()) // the CAM delivers decrypted packets one at a time
+           return cDevice::GetTSPackets(Data, Count);
+        }
+     Data = tsBuffer->GetPackets(Count, MAXTSPACKETSPERGET);
+     return true;
+     }
+  Data = NULL;
+  Count = 0;
+  return false;
+}
+
 void cDvbDevice::DetachAllReceivers(void)
 {
   cMutexLock MutexLock(&bondMutex);
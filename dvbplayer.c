@@ -120,114 +120,306 @@ int cPtsIndex::FindFrameNumber(uint32_t Pts)
   return Valid ? FrameNumber : FindIndex(Pts); // fall back during trick speeds
 }
 
-// --- cNonBlockingFileReader ------------------------------------------------
+// --- cReplayReader ---------------------------------------------------------
 
-class cNonBlockingFileReader : public cThread {
+#define REPLAYBUFSIZE      MEGABYTE(4)   // holds the frames that have been read ahead
+#define REPLAYREADSIZE     KILOBYTE(512) // max. number of bytes read in one go from consecutive frames
+#define REPLAYPREFETCH     32            // default number of frames to read ahead
+
+class cReplayReader : public cThread {
 private:
-  cUnbufferedFile *f;
+  struct tReplayFrame {
+    int index;
+    uint16_t fileNumber;  // 0 means "read from 'file' at its current position"
+    off_t fileOffset;
+    int length;
+    int data;             // offset of this frame's data in 'buffer'
+    int count;            // number of bytes actually read (0 = EOF, < 0 = -errno)
+    };
+  cFileName *fileName;
+  cUnbufferedFile *file;
   uchar *buffer;
-  int wanted;
-  int length;
-  cCondWait newSet;
+  int tail;               // where the next read goes in 'buffer'
+  tReplayFrame *frames;
+  int depth;
+  int head;               // the frame that is or will be requested next
+  int done;               // all frames before this one have been read
+  int end;                // the frame after the last one in the queue
+  int generation;         // incremented by Clear(), so that a read in progress is discarded
+  bool requested;
+  cMutex mutex;
+  cMutex readMutex;       // held while reading, so that 'file' isn't replaced in the meantime
   cCondVar newDataCond;
-  cMutex newDataMutex;
+  cCondWait newSet;
+  tReplayFrame &Frame(int Number) { return frames[Number % depth]; }
+  void Reset(void);
+  void Append(int Index, uint16_t FileNumber, off_t FileOffset, int Length);
+  bool Alloc(int Size, int &Offset);
+  int Read(uint16_t FileNumber, off_t FileOffset, uchar *Data, int Size);
 protected:
   void Action(void);
 public:
-  cNonBlockingFileReader(void);
-  ~cNonBlockingFileReader();
+  cReplayReader(const char *FileName, bool IsPesRecording, int Depth = REPLAYPREFETCH);
+       ///< Creates a reader for the recording with the given FileName, which reads up to
+       ///< Depth frames ahead of the one that is currently requested.
+  ~cReplayReader();
   void Clear(void);
+  void Request(int Index, uint16_t FileNumber, off_t FileOffset, int Length);
+       ///< Requests the frame with the given Index, which is stored at FileOffset in the
+       ///< file with the given FileNumber and has the given Length. If this frame has
+       ///< already been read ahead, it is immediately available through Result().
   void Request(cUnbufferedFile *File, int Length);
+       ///< Requests Length bytes from the current position of File (used if there is no index).
+  void Prefetch(cIndexFile *Index, int Step = 0);
+       ///< Uses the given Index to queue the frames following the last one that has been
+       ///< requested, so that they are read ahead. If Step is 0, these are the next frames
+       ///< in sequence. Otherwise they are the I-frames found at intervals of Step frames
+       ///< (which is negative when going backwards), as used in fast forward/rewind.
   int Result(uchar **Buffer);
-  bool Reading(void) { return buffer; }
+  bool Reading(void) { return requested; }
   bool WaitForDataMs(int msToWait);
   };
 
-cNonBlockingFileReader::cNonBlockingFileReader(void)
-:cThread("non blocking file reader")
+cReplayReader::cReplayReader(const char *FileName, bool IsPesRecording, int Depth)
+:cThread("replay reader")
 {
-  f = NULL;
-  buffer = NULL;
-  wanted = length = 0;
+  fileName = new cFileName(FileName, false, false, IsPesRecording);
+  file = NULL;
+  buffer = MALLOC(uchar, REPLAYBUFSIZE);
+  depth = max(Depth, 1);
+  frames = MALLOC(tReplayFrame, depth);
+  generation = 0;
+  Reset();
   Start();
 }
 
-cNonBlockingFileReader::~cNonBlockingFileReader()
+cReplayReader::~cReplayReader()
 {
   newSet.Signal();
   Cancel(3);
+  free(frames);
   free(buffer);
+  delete fileName;
 }
 
-void cNonBlockingFileReader::Clear(void)
+void cReplayReader::Reset(void)
 {
-  Lock();
-  f = NULL;
-  free(buffer);
-  buffer = NULL;
-  wanted = length = 0;
-  Unlock();
+  head = done = end = 0;
+  tail = 0;
+  generation++;
+  requested = false;
 }
 
-void cNonBlockingFileReader::Request(cUnbufferedFile *File, int Length)
+void cReplayReader::Clear(void)
 {
-  Lock();
-  Clear();
-  wanted = Length;
-  buffer = MALLOC(uchar, wanted);
-  f = File;
-  Unlock();
+  cMutexLock ReadLock(&readMutex);
+  cMutexLock MutexLock(&mutex);
+  Reset();
+  file = NULL;
+}
+
+void cReplayReader::Append(int Index, uint16_t FileNumber, off_t FileOffset, int Length)
+{
+  tReplayFrame &f = Frame(end++);
+  f.index = Index;
+  f.fileNumber = FileNumber;
+  f.fileOffset = FileOffset;
+  f.length = Length;
+  f.data = 0;
+  f.count = 0;
+}
+
+void cReplayReader::Request(int Index, uint16_t FileNumber, off_t FileOffset, int Length)
+{
+  cMutexLock MutexLock(&mutex);
+  if (head < end) {
+     tReplayFrame &f = Frame(head);
+     if (f.index != Index || f.fileNumber != FileNumber || f.fileOffset != FileOffset || f.length != Length)
+        Reset(); // not what we have read ahead
+     }
+  if (head == end)
+     Append(Index, FileNumber, FileOffset, Length);
+  requested = true;
   newSet.Signal();
 }
 
-int cNonBlockingFileReader::Result(uchar **Buffer)
+void cReplayReader::Request(cUnbufferedFile *File, int Length)
 {
-  LOCK_THREAD;
-  if (buffer && length == wanted) {
-     *Buffer = buffer;
-     buffer = NULL;
-     return wanted;
+  cMutexLock ReadLock(&readMutex);
+  cMutexLock MutexLock(&mutex);
+  Reset();
+  file = File;
+  Append(-1, 0, 0, Length);
+  requested = true;
+  newSet.Signal();
+}
+
+void cReplayReader::Prefetch(cIndexFile *Index, int Step)
+{
+  // Frames at or after Last() are not read ahead, because their length isn't known yet
+  // (or they might still be written to) when replaying a recording that is still going on:
+  // Only the caller modifies the queue, so the index doesn't need to be accessed under lock:
+  int Last = Index->Last();
+  while (end > head && end - head < depth) {
+        int i = Frame(end - 1).index;
+        if (Step) {
+           int NewIndex = i + Step;
+           if (NewIndex <= 0 && i > 0)
+              NewIndex = 1; // make sure the very first frame is delivered
+           i = Index->GetNextIFrame(NewIndex, Step > 0);
+           }
+        else
+           i++;
+        uint16_t FileNumber;
+        off_t FileOffset;
+        int Length;
+        if (i < 0 || i >= Last || !Index->Get(i, &FileNumber, &FileOffset, NULL, &Length))
+           break;
+        if (Length < 0 || Length > MAXFRAMESIZE)
+           Length = MAXFRAMESIZE;
+        mutex.Lock();
+        Append(i, FileNumber, FileOffset, Length);
+        mutex.Unlock();
+        }
+  newSet.Signal();
+}
+
+int cReplayReader::Result(uchar **Buffer)
+{
+  cMutexLock MutexLock(&mutex);
+  if (requested && head < done) {
+     tReplayFrame &f = Frame(head++);
+     requested = false;
+     newSet.Signal(); // the buffer space of this frame is free again
+     if (f.count > 0) {
+        *Buffer = MALLOC(uchar, f.count);
+        memcpy(*Buffer, buffer + f.data, f.count);
+        }
+     else if (f.count < 0) {
+        errno = -f.count;
+        return -1;
+        }
+     return f.count;
      }
   errno = EAGAIN;
   return -1;
 }
 
-void cNonBlockingFileReader::Action(void)
+bool cReplayReader::WaitForDataMs(int msToWait)
+{
+  cMutexLock MutexLock(&mutex);
+  if (requested && head < done)
+     return true;
+  return newDataCond.TimedWait(mutex, msToWait);
+}
+
+bool cReplayReader::Alloc(int Size, int &Offset)
+{
+  // The frames in the queue use 'buffer' in the order in which they have been read,
+  // so the used area starts with the oldest frame that has not yet been retrieved:
+  if (head == done) {
+     Offset = 0;
+     return Size <= REPLAYBUFSIZE;
+     }
+  int Start = Frame(head).data;
+  if (tail >= Start) {
+     if (Size <= REPLAYBUFSIZE - tail) {
+        Offset = tail;
+        return true;
+        }
+     if (Size < Start) { // wrap around
+        Offset = 0;
+        return true;
+        }
+     }
+  else if (tail + Size < Start) {
+     Offset = tail;
+     return true;
+     }
+  return false;
+}
+
+int cReplayReader::Read(uint16_t FileNumber, off_t FileOffset, uchar *Data, int Size)
+{
+  // Returns the number of bytes read, or -errno in case of an error:
+  cUnbufferedFile *f = FileNumber ? fileName->SetOffset(FileNumber, FileOffset) : file;
+  if (!f)
+     return -EIO;
+  int Length = 0;
+  while (Length < Size) {
+        int r = f->Read(Data + Length, Size - Length);
+        if (r > 0)
+           Length += r;
+        else if (r == 0) // EOF
+           break;
+        else if (FATALERRNO) {
+           LOG_ERROR;
+           return Length ? Length : -errno;
+           }
+        }
+  return Length;
+}
+
+void cReplayReader::Action(void)
 {
   while (Running()) {
-        Lock();
-        if (f && buffer && length < wanted) {
-           int r = f->Read(buffer + length, wanted - length);
-           if (r > 0)
-              length += r;
-           else if (r == 0) { // r == 0 means EOF
-              if (length > 0)
-                 wanted = length; // already read something, so return the rest
-              else
-                 length = wanted = 0; // report EOF
-              }
-           else if (FATALERRNO) {
-              LOG_ERROR;
-              length = wanted = r; // this will forward the error status to the caller
+        // Collect a run of consecutive frames from the same file that can be read in one go:
+        readMutex.Lock();
+        mutex.Lock();
+        int Generation = generation;
+        int First = done;
+        int n = 0;
+        int Size = 0;
+        while (First + n < end) {
+              tReplayFrame &f = Frame(First + n);
+              if (n) {
+                 tReplayFrame &p = Frame(First + n - 1);
+                 if (!f.fileNumber || f.fileNumber != p.fileNumber || f.fileOffset != p.fileOffset + p.length || Size + f.length > REPLAYREADSIZE)
+                    break;
+                 }
+              Size += f.length;
+              n++;
               }
-           if (length == wanted) {
-              cMutexLock NewDataLock(&newDataMutex);
+        int Offset = 0;
+        uint16_t FileNumber = 0;
+        off_t FileOffset = 0;
+        if (n && Alloc(Size, Offset)) {
+           FileNumber = Frame(First).fileNumber;
+           FileOffset = Frame(First).fileOffset;
+           tail = Offset + Size;
+           }
+        else
+           n = 0;
+        mutex.Unlock();
+        if (n) {
+           int r = Read(FileNumber, FileOffset, buffer + Offset, Size);
+           readMutex.Unlock();
+           cMutexLock MutexLock(&mutex);
+           if (generation == Generation) {
+              // Hand out the data to the frames it belongs to. A frame that has been cut short
+              // by EOF gets what has been read, any further frames get the EOF or error status:
+              for (int i = 0; i < n; i++) {
+                  tReplayFrame &f = Frame(First + i);
+                  f.data = Offset;
+                  if (r > 0) {
+                     f.count = min(r, f.length);
+                     r = f.count < f.length ? 0 : r - f.count;
+                     }
+                  else
+                     f.count = r;
+                  Offset += f.length;
+                  }
+              done = First + n;
               newDataCond.Broadcast();
               }
            }
-        Unlock();
-        newSet.Wait(1000);
+        else {
+           readMutex.Unlock();
+           newSet.Wait(1000);
+           }
         }
 }
 
-bool cNonBlockingFileReader::WaitForDataMs(int msToWait)
-{
-  cMutexLock NewDataLock(&newDataMutex);
-  if (buffer && length == wanted)
-     return true;
-  return newDataCond.TimedWait(newDataMutex, msToWait);
-}
-
 // --- cDvbPlayer ------------------------------------------------------------
 
 #define PLAYERBUFSIZE  MEGABYTE(1)
@@ -240,7 +432,7 @@ private:
   enum ePlayModes { pmPlay, pmPause, pmSlow, pmFast, pmStill };
   enum ePlayDirs { pdForward, pdBackward };
   static int Speeds[];
-  cNonBlockingFileReader *nonBlockingFileReader;
+  cReplayReader *replayReader;
   cRingBufferFrame *ringBuffer;
   cPtsIndex ptsIndex;
   const cMarks *marks;
@@ -297,7 +489,7 @@ int cDvbPlayer::Speeds[] = { 0, -2, -4, -8, 1, 2, 4, 12, 0 };
 cDvbPlayer::cDvbPlayer(const char *FileName, bool PauseLive)
 :cThread("dvbplayer")
 {
-  nonBlockingFileReader = NULL;
+  replayReader = NULL;
   ringBuffer = NULL;
   marks = NULL;
   index = NULL;
@@ -322,6 +514,7 @@ cDvbPlayer::cDvbPlayer(const char *FileName, bool PauseLive)
   if (!replayFile)
      return;
   ringBuffer = new cRingBufferFrame(PLAYERBUFSIZE);
+  replayReader = new cReplayReader(FileName, isPesRecording);
   // Create the index file:
   index = new cIndexFile(FileName, false, isPesRecording, pauseLive);
   if (!index)
@@ -339,6 +532,7 @@ cDvbPlayer::~cDvbPlayer()
   Save();
   Detach();
   delete readFrame; // might not have been stored in the buffer in Action()
+  delete replayReader;
   delete index;
   delete fileName;
   delete ringBuffer;
@@ -373,8 +567,8 @@ void cDvbPlayer::TrickSpeed(int Increment)
 void cDvbPlayer::Empty(void)
 {
   LOCK_THREAD;
-  if (nonBlockingFileReader)
-     nonBlockingFileReader->Clear();
+  if (replayReader)
+     replayReader->Clear();
   if (!firstPacket) // don't set the readIndex twice if Empty() is called more than once
      readIndex = ptsIndex.FindIndex(DeviceGetSTC()) - 1;  // Action() will first increment it!
   delete readFrame; // might not have been stored in the buffer in Action()
@@ -470,7 +664,6 @@ void cDvbPlayer::Action(void)
   if (readIndex > 0) // will first be incremented in the loop!
      --readIndex;
 
-  nonBlockingFileReader = new cNonBlockingFileReader;
   int Length = 0;
   bool Sleep = false;
   bool WaitingForData = false;
@@ -485,7 +678,7 @@ void cDvbPlayer::Action(void)
      Goto(0, true);
   while (Running()) {
         if (WaitingForData)
-           WaitingForData = !nonBlockingFileReader->WaitForDataMs(3); // this keeps the CPU load low, but reacts immediately on new data
+           WaitingForData = !replayReader->WaitForDataMs(3); // this keeps the CPU load low, but reacts immediately on new data
         else if (Sleep) {
            cPoller Poller;
            DevicePoll(Poller, 10);
@@ -500,10 +693,12 @@ void cDvbPlayer::Action(void)
 
           if (playMode != pmStill && playMode != pmPause) {
              if (!readFrame && (replayFile || readIndex >= 0)) {
-                if (!nonBlockingFileReader->Reading() && !AtLastMark) {
+                if (!replayReader->Reading() && !AtLastMark) {
+                   uint16_t FileNumber = 0;
+                   off_t FileOffset = 0;
+                   int FrameIndex = -1; // the frame at FileNumber/FileOffset
+                   int Step = 0;
                    if (!SwitchToPlayFrame && (playMode == pmFast || (playMode == pmSlow && playDir == pdBackward))) {
-                      uint16_t FileNumber;
-                      off_t FileOffset;
                       bool TimeShiftMode = index->IsStillRecording();
                       int Index = -1;
                       readIndependent = false;
@@ -515,6 +710,7 @@ void cDvbPlayer::Action(void)
                          int d = int(round(0.4 * framesPerSecond));
                          if (playDir != pdForward)
                             d = -d;
+                         Step = d;
                          int NewIndex = readIndex + d;
                          if (NewIndex <= 0 && readIndex > 0)
                             NewIndex = 1; // make sure the very first frame is delivered
@@ -526,17 +722,17 @@ void cDvbPlayer::Action(void)
                          }
                       if (Index >= 0) {
                          readIndex = Index;
-                         if (!NextFile(FileNumber, FileOffset))
-                            continue;
+                         FrameIndex = Index;
+                         eof = false; // the replay reader accesses the file itself
                          }
                       else if (!(TimeShiftMode && playDir == pdForward))
                          eof = true;
                       }
                    else if (index) {
-                      uint16_t FileNumber;
-                      off_t FileOffset;
-                      if (index->Get(readIndex + 1, &FileNumber, &FileOffset, &readIndependent, &Length) && NextFile(FileNumber, FileOffset)) {
+                      if (index->Get(readIndex + 1, &FileNumber, &FileOffset, &readIndependent, &Length)) {
                          readIndex++;
+                         FrameIndex = readIndex;
+                         eof = false; // the replay reader accesses the file itself
                          if ((Setup.SkipEdited || Setup.PauseAtLastMark) && marks) {
                             cStateKey StateKey;
                             marks->Lock(StateKey);
@@ -572,12 +768,18 @@ void cDvbPlayer::Action(void)
                       esyslog("ERROR: frame larger than buffer (%d > %d)", Length, MAXFRAMESIZE);
                       Length = MAXFRAMESIZE;
                       }
-                   if (!eof)
-                      nonBlockingFileReader->Request(replayFile, Length);
+                   if (!eof) {
+                      if (FrameIndex >= 0) {
+                         replayReader->Request(FrameIndex, FileNumber, FileOffset, Length);
+                         replayReader->Prefetch(index, Step);
+                         }
+                      else
+                         replayReader->Request(replayFile, Length);
+                      }
                    }
                 if (!eof) {
                    uchar *b = NULL;
-                   int r = nonBlockingFileReader->Result(&b);
+                   int r = replayReader->Result(&b);
                    if (r > 0) {
                       WaitingForData = false;
                       LastReadFrame = readIndex;
@@ -716,10 +918,6 @@ void cDvbPlayer::Action(void)
              }
         }
         }
-
-  cNonBlockingFileReader *nbfr = nonBlockingFileReader;
-  nonBlockingFileReader = NULL;
-  delete nbfr;
 }
 
 void cDvbPlayer::Pause(void)
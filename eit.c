@@ -20,6 +20,14 @@
 
 #define VALID_TIME (31536000 * 2) // two years
 
+static void ExtendTimeWindow(time_t &Begin, time_t &End, time_t StartTime, time_t EndTime)
+{
+  if (!Begin || StartTime < Begin)
+     Begin = StartTime;
+  if (EndTime > End)
+     End = EndTime;
+}
+
 // --- cEIT ------------------------------------------------------------------
 
 class cEIT : public SI::EIT {
@@ -82,13 +90,18 @@ cEIT::cEIT(cSectionSyncerHash &SectionSyncerHash, int Source, u_char Tid, const
   time_t LingerLimit = Now - Setup.EPGLinger * 60;
   time_t SegmentStart = 0;
   time_t SegmentEnd = 0;
+  time_t ChangedBegin = 0; // the time window of all events that are changed
+  time_t ChangedEnd = 0;   // while processing this section
+  bool ChangedAnywhere = handledExternally;
   struct tm t = { 0 };
   localtime_r(&Now, &t); // this initializes the time zone in 't'
 
   SI::EIT::Event SiEitEvent;
   for (SI::Loop::Iterator it; eventLoop.getNext(SiEitEvent, it); ) {
-      if (EpgHandlers.HandleEitEvent(pSchedule, &SiEitEvent, Tid, getVersionNumber()))
+      if (EpgHandlers.HandleEitEvent(pSchedule, &SiEitEvent, Tid, getVersionNumber())) {
+         ChangedAnywhere = true; // we don't know what the EPG handler has changed
          continue; // an EPG handler has done all of the processing
+         }
       time_t StartTime = SiEitEvent.getStartTime();
       int Duration = SiEitEvent.getDuration();
       // Drop bogus events - but keep NVOD reference events, where all bits of the start time field are set to 1, resulting in a negative number.
@@ -101,6 +114,10 @@ cEIT::cEIT(cSectionSyncerHash &SectionSyncerHash, int Source, u_char Tid, const
       if (!SegmentStart)
          SegmentStart = StartTime;
       SegmentEnd = StartTime + Duration;
+      if (StartTime > 0)
+         ExtendTimeWindow(ChangedBegin, ChangedEnd, StartTime, StartTime + Duration);
+      else
+         ChangedAnywhere = true;
       cEvent *newEvent = NULL;
       cEvent *rEvent = NULL;
       cEvent *pEvent = (cEvent *)pSchedule->GetEvent(SiEitEvent.getEventId(), StartTime);
@@ -123,6 +140,10 @@ cEIT::cEIT(cSectionSyncerHash &SectionSyncerHash, int Source, u_char Tid, const
          // The lower the table ID, the more "current" the information.
          if (Tid > TableID)
             continue;
+         if (pEvent->StartTime() > 0)
+            ExtendTimeWindow(ChangedBegin, ChangedEnd, pEvent->StartTime(), pEvent->EndTime()); // the event may be moved away from here
+         else
+            ChangedAnywhere = true;
          EpgHandlers.SetEventID(pEvent, SiEitEvent.getEventId()); // unfortunately some stations use different event ids for the same event in different tables :-(
          EpgHandlers.SetStartTime(pEvent, StartTime);
          EpgHandlers.SetDuration(pEvent, Duration);
@@ -325,9 +346,13 @@ cEIT::cEIT(cSectionSyncerHash &SectionSyncerHash, int Source, u_char Tid, const
      pSchedule->SetPresentSeen();
      }
   if (Modified) {
+     // Let the timers know that only events within this time window have been changed:
+     if (!ChangedAnywhere)
+        pSchedule->LimitModified(ChangedBegin, ChangedEnd);
      EpgHandlers.SortSchedule(pSchedule);
      EpgHandlers.DropOutdated(pSchedule, SegmentStart, SegmentEnd, Tid, getVersionNumber());
      pSchedule->SetModified();
+     pSchedule->LimitModified(0, 0);
      }
   SchedulesStateKey.Remove(Modified);
   ChannelsStateKey.Remove(ChannelsModified);
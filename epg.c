@@ -12,7 +12,9 @@
 
 #include "epg.h"
 #include <ctype.h>
+#include <inttypes.h>
 #include <limits.h>
+#include <sys/mman.h>
 #include <time.h>
 #include "libsi/si.h"
 
@@ -108,6 +110,152 @@ tComponent *cComponents::GetComponent(int Index, uchar Stream, uchar Type)
   return NULL;
 }
 
+// --- cEpgStrings -----------------------------------------------------------
+
+// The texts of the events are kept in a global, reference counted string
+// store, so that identical titles, short texts and descriptions (as they
+// are typical for series or boilerplate texts) are stored only once.
+
+#define EPGSTRINGSBUCKETS  4096 // initial number of hash buckets (power of 2)
+
+class cEpgStrings {
+private:
+  struct tEpgString {
+    tEpgString *next;
+    unsigned int hash;
+    int refs;
+    int length;
+    char text[1];
+    };
+  cMutex mutex;
+  tEpgString **buckets;
+  int numBuckets;
+  int numStrings;
+  int numRefs;
+  int64_t storedBytes;
+  int64_t referencedBytes;
+  static unsigned int Hash(const char *s, int &Length);
+  void Resize(int NumBuckets);
+public:
+  cEpgStrings(void);
+  const char *Get(const char *s);
+       ///< Returns a shared copy of the given string, or NULL if s is NULL.
+       ///< Every string returned by Get() must be given back with Put().
+  void Put(const char *s);
+  void Report(void);
+       ///< Logs the number of texts in the store and the memory that has been
+       ///< saved by storing identical texts only once.
+  };
+
+// The string store is created on first use and never destroyed, because events
+// may still be deleted by other static objects' destructors at program exit:
+
+static cEpgStrings &EpgStrings(void)
+{
+  static cEpgStrings *Strings = new cEpgStrings;
+  return *Strings;
+}
+
+cEpgStrings::cEpgStrings(void)
+{
+  buckets = NULL;
+  numBuckets = 0;
+  numStrings = 0;
+  numRefs = 0;
+  storedBytes = 0;
+  referencedBytes = 0;
+  Resize(EPGSTRINGSBUCKETS);
+}
+
+unsigned int cEpgStrings::Hash(const char *s, int &Length)
+{
+  // FNV-1a:
+  unsigned int h = 2166136261U;
+  const char *p = s;
+  for (; *p; p++)
+      h = (h ^ uchar(*p)) * 16777619U;
+  Length = p - s;
+  return h;
+}
+
+void cEpgStrings::Resize(int NumBuckets)
+{
+  if (tEpgString **NewBuckets = (tEpgString **)calloc(NumBuckets, sizeof(tEpgString *))) {
+     for (int i = 0; i < numBuckets; i++) {
+         while (tEpgString *p = buckets[i]) {
+               buckets[i] = p->next;
+               tEpgString **b = &NewBuckets[p->hash & (NumBuckets - 1)];
+               p->next = *b;
+               *b = p;
+               }
+         }
+     free(buckets);
+     buckets = NewBuckets;
+     numBuckets = NumBuckets;
+     }
+}
+
+const char *cEpgStrings::Get(const char *s)
+{
+  if (!s)
+     return NULL;
+  int Length;
+  unsigned int h = Hash(s, Length);
+  cMutexLock MutexLock(&mutex);
+  tEpgString **b = &buckets[h & (numBuckets - 1)];
+  tEpgString *p = *b;
+  while (p && (p->hash != h || p->length != Length || memcmp(p->text, s, Length) != 0))
+        p = p->next;
+  if (!p) {
+     int Size = offsetof(tEpgString, text) + Length + 1;
+     if ((p = (tEpgString *)malloc(Size)) == NULL) {
+        esyslog("ERROR: out of memory");
+        return NULL;
+        }
+     p->hash = h;
+     p->refs = 0;
+     p->length = Length;
+     memcpy(p->text, s, Length + 1);
+     p->next = *b;
+     *b = p;
+     numStrings++;
+     storedBytes += Size;
+     if (numStrings > numBuckets)
+        Resize(numBuckets * 2);
+     }
+  p->refs++;
+  numRefs++;
+  referencedBytes += Length + 1;
+  return p->text;
+}
+
+void cEpgStrings::Put(const char *s)
+{
+  if (!s)
+     return;
+  tEpgString *p = (tEpgString *)(s - offsetof(tEpgString, text));
+  cMutexLock MutexLock(&mutex);
+  numRefs--;
+  referencedBytes -= p->length + 1;
+  if (--p->refs == 0) {
+     for (tEpgString **b = &buckets[p->hash & (numBuckets - 1)]; *b; b = &(*b)->next) {
+         if (*b == p) {
+            *b = p->next;
+            break;
+            }
+         }
+     numStrings--;
+     storedBytes -= offsetof(tEpgString, text) + p->length + 1;
+     free(p);
+     }
+}
+
+void cEpgStrings::Report(void)
+{
+  cMutexLock MutexLock(&mutex);
+  dsyslog("EPG texts: %d stored for %d uses, %" PRId64 " KB allocated, %" PRId64 " KB saved", numStrings, numRefs, storedBytes / KILOBYTE(1), (referencedBytes - storedBytes) / KILOBYTE(1));
+}
+
 // --- cEvent ----------------------------------------------------------------
 
 cMutex cEvent::numTimersMutex;
@@ -135,9 +283,9 @@ cEvent::cEvent(tEventID EventID)
 
 cEvent::~cEvent()
 {
-  free(title);
-  free(shortText);
-  free(description);
+  EpgStrings().Put(title);
+  EpgStrings().Put(shortText);
+  EpgStrings().Put(description);
   free(aux);
   delete components;
 }
@@ -183,17 +331,23 @@ void cEvent::SetRunningStatus(int RunningStatus, const cChannel *Channel)
 
 void cEvent::SetTitle(const char *Title)
 {
-  title = strcpyrealloc(title, Title);
+  const char *Old = title;
+  title = EpgStrings().Get(Title);
+  EpgStrings().Put(Old);
 }
 
 void cEvent::SetShortText(const char *ShortText)
 {
-  shortText = strcpyrealloc(shortText, ShortText);
+  const char *Old = shortText;
+  shortText = EpgStrings().Get(ShortText);
+  EpgStrings().Put(Old);
 }
 
 void cEvent::SetDescription(const char *Description)
 {
-  description = strcpyrealloc(description, Description);
+  const char *Old = description;
+  description = EpgStrings().Get(Description);
+  EpgStrings().Put(Old);
 }
 
 void cEvent::SetComponents(cComponents *Components)
@@ -227,6 +381,8 @@ void cEvent::SetStartTime(time_t StartTime)
 void cEvent::SetDuration(int Duration)
 {
   duration = Duration;
+  if (schedule && duration > schedule->maxDuration)
+     schedule->maxDuration = duration;
 }
 
 void cEvent::SetVps(time_t Vps)
@@ -448,6 +604,22 @@ cString cEvent::GetVpsString(void) const
   return buf;
 }
 
+static void DumpText(FILE *f, const char *s)
+{
+  // Writes s with any newline characters replaced by '|', without modifying s itself
+  // (which may be shared with other events, or be read by several threads in parallel):
+  while (*s) {
+        size_t l = strcspn(s, "\n");
+        fwrite(s, 1, l, f);
+        s += l;
+        if (*s) {
+           fputc('|', f);
+           s++;
+           }
+        }
+  fputc('\n', f);
+}
+
 void cEvent::Dump(FILE *f, const char *Prefix, bool InfoOnly) const
 {
   if (InfoOnly || startTime + duration + Setup.EPGLinger * 60 >= time(NULL)) {
@@ -457,9 +629,8 @@ void cEvent::Dump(FILE *f, const char *Prefix, bool InfoOnly) const
      if (!isempty(shortText))
         fprintf(f, "%sS %s\n", Prefix, shortText);
      if (!isempty(description)) {
-        strreplace(description, '\n', '|');
-        fprintf(f, "%sD %s\n", Prefix, description);
-        strreplace(description, '|', '\n');
+        fprintf(f, "%sD ", Prefix);
+        DumpText(f, description);
         }
      if (contents[0]) {
         fprintf(f, "%sG", Prefix);
@@ -478,9 +649,8 @@ void cEvent::Dump(FILE *f, const char *Prefix, bool InfoOnly) const
      if (vps)
         fprintf(f, "%sV %ld\n", Prefix, vps);
      if (!InfoOnly && !isempty(aux)) {
-        strreplace(aux, '\n', '|');
-        fprintf(f, "%s@ %s\n", Prefix, aux);
-        strreplace(aux, '|', '\n');
+        fprintf(f, "%s@ ", Prefix);
+        DumpText(f, aux);
         }
      if (!InfoOnly)
         fprintf(f, "%se\n", Prefix);
@@ -689,6 +859,12 @@ static void StripControlCharacters(char *s)
 
 void cEvent::FixEpgBugs(void)
 {
+  // The texts may be shared with other events, so the fixes are applied to
+  // private copies, which are stored again at the end:
+  char *title = this->title ? strdup(this->title) : NULL;
+  char *shortText = this->shortText ? strdup(this->shortText) : NULL;
+  char *description = this->description ? strdup(this->description) : NULL;
+
   if (isempty(title)) {
      // we don't want any "(null)" titles
      title = strcpyrealloc(title, tr("No title"));
@@ -900,6 +1076,13 @@ Final:
   StripControlCharacters(title);
   StripControlCharacters(shortText);
   StripControlCharacters(description);
+
+  SetTitle(title);
+  SetShortText(shortText);
+  SetDescription(description);
+  free(title);
+  free(shortText);
+  free(description);
 }
 
 // --- cSchedule -------------------------------------------------------------
@@ -910,12 +1093,65 @@ cSchedule::cSchedule(tChannelID ChannelID)
 {
   channelID = ChannelID;
   events.SetUseGarbageCollector();
+  eventsByTimeValid = false;
+  maxDuration = 0;
+  runningEvent = NULL;
   numTimers = 0;
   hasRunning = false;
   modified = 0;
+  numChanges = 0;
+  changesFrom = 0;
+  limitBegin = limitEnd = 0;
   presentSeen = 0;
 }
 
+bool cSchedule::Modified(int &State, time_t Begin, time_t End) const
+{
+  bool Result = false;
+  if (State != modified) {
+     if (State < changesFrom || State > modified)
+        Result = true; // State is older than the changes we know of (or not from this schedule at all)
+     else {
+        for (int i = numChanges - 1; i >= 0 && changes[i].state > State; i--) {
+            if (changes[i].begin <= End && Begin <= changes[i].end) {
+               Result = true;
+               break;
+               }
+            }
+        }
+     }
+  State = modified;
+  return Result;
+}
+
+void cSchedule::SetModified(void)
+{
+  modified++;
+  if (limitBegin || limitEnd) {
+     if (numChanges == MAXSCHEDULECHANGES) {
+        // Merge the two oldest changes:
+        changes[1].begin = min(changes[0].begin, changes[1].begin);
+        changes[1].end = max(changes[0].end, changes[1].end);
+        memmove(&changes[0], &changes[1], (--numChanges) * sizeof(tChange));
+        }
+     changes[numChanges].state = modified;
+     changes[numChanges].begin = limitBegin;
+     changes[numChanges].end = limitEnd;
+     numChanges++;
+     }
+  else {
+     // Any event may have changed, so there is no need to remember earlier changes:
+     numChanges = 0;
+     changesFrom = modified;
+     }
+}
+
+void cSchedule::LimitModified(time_t Begin, time_t End)
+{
+  limitBegin = Begin;
+  limitEnd = End;
+}
+
 void cSchedule::IncNumTimers(void) const
 {
   numTimersMutex.Lock();
@@ -934,6 +1170,7 @@ cEvent *cSchedule::AddEvent(cEvent *Event)
 {
   events.Add(Event);
   Event->schedule = this;
+  maxDuration = max(maxDuration, Event->Duration());
   HashEvent(Event);
   return Event;
 }
@@ -941,6 +1178,16 @@ cEvent *cSchedule::AddEvent(cEvent *Event)
 void cSchedule::DelEvent(cEvent *Event)
 {
   if (Event->schedule == this) {
+     if (Event == runningEvent)
+        runningEvent = NULL;
+     if (eventsByTimeValid) {
+        for (int i = FirstEventAfter(Event->StartTime() - 1); i < eventsByTime.Size(); i++) {
+            if (eventsByTime[i] == Event) {
+               eventsByTime.Remove(i);
+               break;
+               }
+            }
+        }
      UnhashEvent(Event);
      events.Del(Event);
      }
@@ -948,6 +1195,7 @@ void cSchedule::DelEvent(cEvent *Event)
 
 void cSchedule::HashEvent(cEvent *Event)
 {
+  eventsByTimeValid = false; // a new event or a changed start time requires a Sort()
   eventsHashID.Add(Event, Event->EventID());
   if (Event->StartTime() > 0) // 'StartTime < 0' is apparently used with NVOD channels
      eventsHashStartTime.Add(Event, Event->StartTime());
@@ -960,10 +1208,36 @@ void cSchedule::UnhashEvent(cEvent *Event)
      eventsHashStartTime.Del(Event, Event->StartTime());
 }
 
+int cSchedule::FirstEventAfter(time_t Time) const
+{
+  int Lo = 0;
+  int Hi = eventsByTime.Size();
+  while (Lo < Hi) {
+        int i = (Lo + Hi) / 2;
+        if (eventsByTime[i]->StartTime() <= Time)
+           Lo = i + 1;
+        else
+           Hi = i;
+        }
+  return Lo;
+}
+
 const cEvent *cSchedule::GetPresentEvent(void) const
 {
   const cEvent *pe = NULL;
   time_t now = time(NULL);
+  if (eventsByTimeValid) {
+     // Only runningEvent can be 'running', since SetRunningStatus() resets all earlier events.
+     // If it is no longer valid, the running states of all events need to be checked:
+     if (runningEvent) {
+        if (runningEvent->StartTime() <= now + 3600 && runningEvent->SeenWithin(RUNNINGSTATUSTIMEOUT) && runningEvent->RunningStatus() >= SI::RunningStatusPausing)
+           return runningEvent;
+        }
+     else if (!hasRunning) {
+        int i = FirstEventAfter(now);
+        return i > 0 ? eventsByTime[i - 1] : NULL;
+        }
+     }
   for (const cEvent *p = events.First(); p; p = events.Next(p)) {
       if (p->StartTime() <= now)
          pe = p;
@@ -980,6 +1254,11 @@ const cEvent *cSchedule::GetFollowingEvent(void) const
   const cEvent *p = GetPresentEvent();
   if (p)
      p = events.Next(p);
+  else if (eventsByTimeValid) {
+     int i = FirstEventAfter(time(NULL) - 1);
+     if (i < eventsByTime.Size())
+        p = eventsByTime[i];
+     }
   else {
      time_t now = time(NULL);
      for (p = events.First(); p; p = events.Next(p)) {
@@ -1003,6 +1282,20 @@ const cEvent *cSchedule::GetEvent(tEventID EventID, time_t StartTime) const
 const cEvent *cSchedule::GetEventAround(time_t Time) const
 {
   const cEvent *pe = NULL;
+  if (eventsByTimeValid) {
+     // Walk back from the last event that starts at or before Time, taking the first one
+     // (in list order) with the latest start time that still covers Time:
+     for (int i = FirstEventAfter(Time) - 1; i >= 0; i--) {
+         const cEvent *p = eventsByTime[i];
+         if (pe && p->StartTime() < pe->StartTime())
+            break;
+         if (p->StartTime() + maxDuration < Time)
+            break; // neither this nor any earlier event can last until Time
+         if (p->EndTime() >= Time)
+            pe = p;
+         }
+     return pe;
+     }
   time_t delta = INT_MAX;
   for (const cEvent *p = events.First(); p; p = events.Next(p)) {
       time_t dt = Time - p->StartTime();
@@ -1014,6 +1307,19 @@ const cEvent *cSchedule::GetEventAround(time_t Time) const
   return pe;
 }
 
+const cEvent *cSchedule::GetEventEndingAfter(time_t Time) const
+{
+  const cEvent *p = events.First();
+  if (eventsByTimeValid) {
+     // Events that start before Time - maxDuration have certainly ended before Time:
+     int i = FirstEventAfter(Time - maxDuration - 1);
+     p = i < eventsByTime.Size() ? eventsByTime[i] : NULL;
+     }
+  while (p && p->EndTime() <= Time)
+        p = events.Next(p);
+  return p;
+}
+
 void cSchedule::SetRunningStatus(cEvent *Event, int RunningStatus, const cChannel *Channel)
 {
   hasRunning = false;
@@ -1021,6 +1327,10 @@ void cSchedule::SetRunningStatus(cEvent *Event, int RunningStatus, const cChanne
       if (p == Event) {
          if (p->RunningStatus() > SI::RunningStatusNotRunning || RunningStatus > SI::RunningStatusNotRunning) {
             p->SetRunningStatus(RunningStatus, Channel);
+            if (RunningStatus >= SI::RunningStatusPausing)
+               runningEvent = p;
+            else if (p == runningEvent)
+               runningEvent = NULL;
             break;
             }
          }
@@ -1039,6 +1349,8 @@ void cSchedule::ClrRunningStatus(cChannel *Channel)
          if (p->RunningStatus() >= SI::RunningStatusPausing) {
             p->SetRunningStatus(SI::RunningStatusNotRunning, Channel);
             hasRunning = false;
+            if (p == runningEvent)
+               runningEvent = NULL;
             break;
             }
          }
@@ -1051,9 +1363,21 @@ void cSchedule::ResetVersions(void)
       p->SetVersion(0xFF);
 }
 
+void cSchedule::IndexEvents(void)
+{
+  eventsByTime.Clear();
+  maxDuration = 0;
+  for (cEvent *p = events.First(); p; p = events.Next(p)) {
+      eventsByTime.Append(p);
+      maxDuration = max(maxDuration, p->Duration());
+      }
+  eventsByTimeValid = true;
+}
+
 void cSchedule::Sort(void)
 {
   events.Sort();
+  IndexEvents();
   // Make sure there are no RunningStatusUndefined before the currently running event:
   if (hasRunning) {
      for (cEvent *p = events.First(); p; p = events.Next(p)) {
@@ -1069,6 +1393,11 @@ void cSchedule::DropOutdated(time_t SegmentStart, time_t SegmentEnd, uchar Table
 {
   if (SegmentStart > 0 && SegmentEnd > 0) {
      cEvent *p = events.First();
+     if (eventsByTimeValid) {
+        // Skip all events that end before SegmentStart:
+        int i = FirstEventAfter(SegmentStart - maxDuration);
+        p = i < eventsByTime.Size() ? eventsByTime[i] : NULL;
+        }
      while (p) {
            cEvent *n = events.Next(p);
            if (p->EndTime() > SegmentStart) {
@@ -1095,13 +1424,26 @@ void cSchedule::Cleanup(void)
 
 void cSchedule::Cleanup(time_t Time)
 {
+  // Removing the events from the time index one by one would be expensive, so
+  // the index is rebuilt once after all outdated events have been deleted:
+  bool Indexed = eventsByTimeValid;
+  bool Deleted = false;
+  eventsByTimeValid = false;
   cEvent *Event;
   while ((Event = events.First()) != NULL) {
-        if (!Event->HasTimer() && Event->EndTime() + Setup.EPGLinger * 60 < Time)
+        if (!Event->HasTimer() && Event->EndTime() + Setup.EPGLinger * 60 < Time) {
            DelEvent(Event);
+           Deleted = true;
+           }
         else
            break;
         }
+  if (Indexed) {
+     if (Deleted)
+        IndexEvents(); // deleting events doesn't change the order of the remaining ones
+     else
+        eventsByTimeValid = true;
+     }
 }
 
 void cSchedule::Dump(const cChannels *Channels, FILE *f, const char *Prefix, eDumpMode DumpMode, time_t AtTime) const
@@ -1213,10 +1555,213 @@ void cEpgDataWriter::Perform(void)
   }
   if (dump)
      cSchedules::Dump();
+  EpgStrings().Report();
 }
 
 static cEpgDataWriter EpgDataWriter;
 
+// --- EPG data snapshot -----------------------------------------------------
+
+// The binary EPG data snapshot consists of a header, followed by the schedule
+// records, the event records (in the order of their schedules), the component
+// records (in the order of their events) and the string table. Strings are
+// given as offsets into the string table, where 0 means "no string". Numbers
+// are stored in the byte order of the machine that wrote the snapshot.
+
+#define EPGSNAPSHOTMAGIC     "VDR-EPG" // a text file always starts with 'C'
+#define EPGSNAPSHOTVERSION   1
+#define EPGSNAPSHOTBYTEORDER 0x01020304
+
+struct tEpgSnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint32_t numSchedules;
+  uint32_t numEvents;
+  uint32_t numComponents;
+  uint32_t stringsSize;
+  int64_t created;
+  };
+
+struct tEpgSnapshotSchedule {
+  int32_t source;
+  int32_t nid;
+  int32_t tid;
+  int32_t sid;
+  int32_t rid;
+  uint32_t numEvents;
+  };
+
+struct tEpgSnapshotEvent {
+  int64_t startTime;
+  int64_t vps;
+  uint32_t eventID;
+  int32_t duration;
+  uint32_t title;
+  uint32_t shortText;
+  uint32_t description;
+  uint32_t aux;
+  uint32_t numComponents;
+  uchar tableID;
+  uchar parentalRating;
+  uchar contents[MaxEventContents];
+  };
+
+struct tEpgSnapshotComponent {
+  uint32_t description;
+  uchar stream;
+  uchar type;
+  char language[MAXLANGCODE2];
+  };
+
+class cEpgSnapshotWriter {
+private:
+  tEpgSnapshotHeader header;
+  cDynamicBuffer schedules;
+  cDynamicBuffer events;
+  cDynamicBuffer components;
+  cDynamicBuffer strings;
+  uint32_t String(const char *s);
+  bool Write(FILE *f, const void *Data, size_t Length);
+public:
+  cEpgSnapshotWriter(void);
+  void AddSchedule(const cSchedule *Schedule, time_t Oldest);
+       ///< Adds the given Schedule, with all events that end at or after Oldest.
+  bool Write(FILE *f);
+  };
+
+cEpgSnapshotWriter::cEpgSnapshotWriter(void)
+:schedules(KILOBYTE(4))
+,events(MEGABYTE(1))
+,components(KILOBYTE(64))
+,strings(MEGABYTE(4))
+{
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, EPGSNAPSHOTMAGIC, sizeof(header.magic));
+  header.version = EPGSNAPSHOTVERSION;
+  header.byteOrder = EPGSNAPSHOTBYTEORDER;
+  header.created = time(NULL);
+  strings.Append(0); // offset 0 means "no string"
+}
+
+uint32_t cEpgSnapshotWriter::String(const char *s)
+{
+  if (isempty(s))
+     return 0;
+  uint32_t Offset = strings.Length();
+  strings.Append((const uchar *)s, strlen(s) + 1);
+  return Offset;
+}
+
+void cEpgSnapshotWriter::AddSchedule(const cSchedule *Schedule, time_t Oldest)
+{
+  tEpgSnapshotSchedule s;
+  tChannelID ChannelID = Schedule->ChannelID();
+  s.source = ChannelID.Source();
+  s.nid = ChannelID.Nid();
+  s.tid = ChannelID.Tid();
+  s.sid = ChannelID.Sid();
+  s.rid = ChannelID.Rid();
+  s.numEvents = 0;
+  const cList<cEvent> *Events = Schedule->Events();
+  for (const cEvent *Event = Events->First(); Event; Event = Events->Next(Event)) {
+      if (Event->EndTime() < Oldest)
+         continue;
+      tEpgSnapshotEvent e;
+      memset(&e, 0, sizeof(e)); // so that the padding is always written the same way
+      e.startTime = Event->StartTime();
+      e.vps = Event->Vps();
+      e.eventID = Event->EventID();
+      e.duration = Event->Duration();
+      e.title = String(Event->Title());
+      e.shortText = String(Event->ShortText());
+      e.description = String(Event->Description());
+      e.aux = String(Event->Aux());
+      e.tableID = Event->TableID();
+      e.parentalRating = Event->ParentalRating();
+      for (int i = 0; i < MaxEventContents; i++)
+          e.contents[i] = Event->Contents(i);
+      if (const cComponents *Components = Event->Components()) {
+         for (int i = 0; i < Components->NumComponents(); i++) {
+             tComponent *p = Components->Component(i);
+             tEpgSnapshotComponent c;
+             memset(&c, 0, sizeof(c));
+             c.description = String(p->description);
+             c.stream = p->stream;
+             c.type = p->type;
+             strn0cpy(c.language, p->language, sizeof(c.language));
+             components.Append((const uchar *)&c, sizeof(c));
+             e.numComponents++;
+             }
+         header.numComponents += e.numComponents;
+         }
+      events.Append((const uchar *)&e, sizeof(e));
+      s.numEvents++;
+      }
+  schedules.Append((const uchar *)&s, sizeof(s));
+  header.numSchedules++;
+  header.numEvents += s.numEvents;
+}
+
+bool cEpgSnapshotWriter::Write(FILE *f, const void *Data, size_t Length)
+{
+  return Length == 0 || fwrite(Data, Length, 1, f) == 1;
+}
+
+bool cEpgSnapshotWriter::Write(FILE *f)
+{
+  header.stringsSize = strings.Length();
+  return Write(f, &header, sizeof(header))
+      && Write(f, schedules.Data(), schedules.Length())
+      && Write(f, events.Data(), events.Length())
+      && Write(f, components.Data(), components.Length())
+      && Write(f, strings.Data(), strings.Length());
+}
+
+static bool EpgSnapshotValid(const uchar *Data, size_t Size)
+{
+  const tEpgSnapshotHeader *h = (const tEpgSnapshotHeader *)Data;
+  if (h->version != EPGSNAPSHOTVERSION || h->byteOrder != EPGSNAPSHOTBYTEORDER) {
+     esyslog("ERROR: unsupported EPG snapshot version %u", h->version);
+     return false;
+     }
+  uint64_t Expected = sizeof(*h) + uint64_t(h->numSchedules) * sizeof(tEpgSnapshotSchedule)
+                                 + uint64_t(h->numEvents) * sizeof(tEpgSnapshotEvent)
+                                 + uint64_t(h->numComponents) * sizeof(tEpgSnapshotComponent)
+                                 + h->stringsSize;
+  if (Expected != Size || h->stringsSize == 0 || Data[Size - 1] != 0) {
+     esyslog("ERROR: invalid EPG snapshot size (%zu, expected %" PRIu64 ")", Size, Expected);
+     return false;
+     }
+  // Make sure all counts and string offsets are consistent, so that reading
+  // the snapshot never needs to check anything:
+  const tEpgSnapshotSchedule *s = (const tEpgSnapshotSchedule *)(h + 1);
+  const tEpgSnapshotEvent *e = (const tEpgSnapshotEvent *)(s + h->numSchedules);
+  const tEpgSnapshotComponent *c = (const tEpgSnapshotComponent *)(e + h->numEvents);
+  uint64_t NumEvents = 0;
+  for (uint32_t i = 0; i < h->numSchedules; i++)
+      NumEvents += s[i].numEvents;
+  uint64_t NumComponents = 0;
+  for (uint32_t i = 0; i < h->numEvents; i++) {
+      NumComponents += e[i].numComponents;
+      if (e[i].title >= h->stringsSize || e[i].shortText >= h->stringsSize || e[i].description >= h->stringsSize || e[i].aux >= h->stringsSize) {
+         esyslog("ERROR: invalid string in EPG snapshot event %u", i);
+         return false;
+         }
+      }
+  for (uint32_t i = 0; i < h->numComponents; i++) {
+      if (c[i].description >= h->stringsSize || c[i].language[MAXLANGCODE2 - 1]) {
+         esyslog("ERROR: invalid string in EPG snapshot component %u", i);
+         return false;
+         }
+      }
+  if (NumEvents != h->numEvents || NumComponents != h->numComponents) {
+     esyslog("ERROR: inconsistent EPG snapshot data");
+     return false;
+     }
+  return true;
+}
+
 // --- cSchedules ------------------------------------------------------------
 
 cSchedules cSchedules::schedules;
@@ -1270,6 +1815,8 @@ bool cSchedules::Dump(FILE *f, const char *Prefix, eDumpMode DumpMode, time_t At
 {
   cSafeFile *sf = NULL;
   if (!f) {
+     if (Setup.EPGBinaryData)
+        return DumpSnapshot();
      sf = new cSafeFile(epgDataFileName);
      if (sf->Open())
         f = *sf;
@@ -1290,11 +1837,130 @@ bool cSchedules::Dump(FILE *f, const char *Prefix, eDumpMode DumpMode, time_t At
   return true;
 }
 
+bool cSchedules::DumpSnapshot(void)
+{
+  cEpgSnapshotWriter Writer;
+  {
+    LOCK_CHANNELS_READ;
+    LOCK_SCHEDULES_READ;
+    time_t Oldest = time(NULL) - Setup.EPGLinger * 60;
+    for (const cSchedule *p = Schedules->First(); p; p = Schedules->Next(p)) {
+        if (Channels->GetByChannelID(p->ChannelID(), true))
+           Writer.AddSchedule(p, Oldest);
+        }
+  }
+  // The actual writing is done without holding any locks:
+  cSafeFile f(epgDataFileName);
+  if (f.Open()) {
+     if (!Writer.Write(f)) {
+        LOG_ERROR_STR(epgDataFileName);
+        f.Discard();
+        return false;
+        }
+     return f.Close();
+     }
+  return false;
+}
+
+int cSchedules::ReadSnapshot(void)
+{
+  int Result = -1;
+  int f = open(epgDataFileName, O_RDONLY);
+  if (f >= 0) {
+     struct stat buf;
+     if (fstat(f, &buf) == 0 && buf.st_size >= off_t(sizeof(tEpgSnapshotHeader))) {
+        size_t Size = buf.st_size;
+        void *p = mmap(NULL, Size, PROT_READ, MAP_PRIVATE, f, 0);
+        if (p != MAP_FAILED) {
+           const uchar *Data = (const uchar *)p;
+           if (memcmp(Data, EPGSNAPSHOTMAGIC, sizeof(EPGSNAPSHOTMAGIC)) == 0) {
+              dsyslog("reading EPG snapshot from %s", epgDataFileName);
+              Result = 0;
+              if (EpgSnapshotValid(Data, Size)) {
+                 madvise(p, Size, MADV_SEQUENTIAL);
+                 // The events are created without holding any locks:
+                 const tEpgSnapshotHeader *h = (const tEpgSnapshotHeader *)Data;
+                 const tEpgSnapshotSchedule *s = (const tEpgSnapshotSchedule *)(h + 1);
+                 const tEpgSnapshotEvent *e = (const tEpgSnapshotEvent *)(s + h->numSchedules);
+                 const tEpgSnapshotComponent *c = (const tEpgSnapshotComponent *)(e + h->numEvents);
+                 const char *Strings = (const char *)(c + h->numComponents);
+                 cVector<cSchedule *> Loaded(h->numSchedules);
+                 for (uint32_t i = 0; i < h->numSchedules; i++, s++) {
+                     tChannelID ChannelID(s->source, s->nid, s->tid, s->sid, s->rid);
+                     cSchedule *Schedule = new cSchedule(ChannelID.ClrRid());
+                     for (uint32_t n = 0; n < s->numEvents; n++, e++) {
+                         cEvent *Event = new cEvent(e->eventID);
+                         Event->seen = 0;
+                         Event->SetTableID(e->tableID);
+                         Event->SetStartTime(e->startTime);
+                         Event->SetDuration(e->duration);
+                         Event->SetTitle(e->title ? Strings + e->title : tr("No title"));
+                         if (e->shortText)
+                            Event->SetShortText(Strings + e->shortText);
+                         if (e->description)
+                            Event->SetDescription(Strings + e->description);
+                         if (e->aux)
+                            Event->SetAux(Strings + e->aux);
+                         Event->SetContents((uchar *)e->contents);
+                         Event->SetParentalRating(e->parentalRating);
+                         Event->SetVps(e->vps);
+                         if (e->numComponents) {
+                            cComponents *Components = new cComponents;
+                            for (uint32_t k = 0; k < e->numComponents; k++, c++)
+                                Components->SetComponent(k, c->stream, c->type, c->language, c->description ? Strings + c->description : NULL);
+                            Event->SetComponents(Components);
+                            }
+                         Schedule->AddEvent(Event);
+                         }
+                     Schedule->Sort();
+                     Loaded.Append(Schedule);
+                     }
+                 // Only the final hand over of the schedules requires the locks:
+                 LOCK_CHANNELS_WRITE;
+                 LOCK_SCHEDULES_WRITE;
+                 for (int i = 0; i < Loaded.Size(); i++) {
+                     cSchedule *Schedule = Loaded[i];
+                     if (cSchedule *Existing = (cSchedule *)Schedules->GetSchedule(Schedule->ChannelID())) {
+                        // EPG data for this channel has already been received, so we only take the missing events:
+                        for (cEvent *Event = Schedule->events.First(); Event; ) {
+                            cEvent *Next = Schedule->events.Next(Event);
+                            if (!Existing->GetEvent(Event->EventID(), Event->StartTime())) {
+                               Schedule->UnhashEvent(Event);
+                               Schedule->events.Del(Event, false);
+                               Existing->AddEvent(Event);
+                               }
+                            Event = Next;
+                            }
+                        Existing->Sort();
+                        delete Schedule;
+                        }
+                     else
+                        Schedules->Add(Schedule);
+                     }
+                 // Initialize the channels' schedule pointers, so that the first WhatsOn menu will come up faster:
+                 for (cChannel *Channel = Channels->First(); Channel; Channel = Channels->Next(Channel))
+                     Schedules->GetSchedule(Channel);
+                 Result = 1;
+                 }
+              }
+           munmap(p, Size);
+           }
+        else
+           LOG_ERROR_STR(epgDataFileName);
+        }
+     close(f);
+     }
+  return Result;
+}
+
 bool cSchedules::Read(FILE *f)
 {
   bool OwnFile = f == NULL;
   if (OwnFile) {
      if (epgDataFileName && access(epgDataFileName, R_OK) == 0) {
+        int Snapshot = ReadSnapshot();
+        if (Snapshot >= 0)
+           return Snapshot > 0;
         dsyslog("reading EPG data from %s", epgDataFileName);
         if ((f = fopen(epgDataFileName, "r")) == NULL) {
            LOG_ERROR;
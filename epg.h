@@ -70,6 +70,7 @@ typedef u_int32_t tEventID;
 
 class cEvent : public cListObject {
   friend class cSchedule;
+  friend class cSchedules;
 private:
   static cMutex numTimersMutex; // Protects numTimers, because it might be accessed from parallel read locks
   // The sequence of these parameters is optimized for minimal memory waste!
@@ -80,9 +81,9 @@ private:
   uchar version;           // Version number of section this event came from
   uchar runningStatus;     // 0=undefined, 1=not running, 2=starts in a few seconds, 3=pausing, 4=running
   uchar parentalRating;    // Parental rating of this event
-  char *title;             // Title of this event
-  char *shortText;         // Short description of this event (typically the episode name in case of a series)
-  char *description;       // Description of this event
+  const char *title;       // Title of this event (shared with other events)
+  const char *shortText;   // Short description of this event (typically the episode name in case of a series, shared with other events)
+  const char *description; // Description of this event (shared with other events)
   cComponents *components; // The stream components of this event
   time_t startTime;        // Start time of this event
   int duration;            // Duration of this event in seconds
@@ -147,24 +148,54 @@ public:
 
 class cSchedules;
 
+#define MAXSCHEDULECHANGES 8 // the number of changes for which cSchedule remembers the affected time window
+
 class cSchedule : public cListObject  {
+  friend class cEvent;
+  friend class cSchedules;
 private:
+  struct tChange {
+    int state;    // the value of 'modified' after this change
+    time_t begin; // the time window of the events
+    time_t end;   // that have been changed
+    };
   static cMutex numTimersMutex; // Protects numTimers, because it might be accessed from parallel read locks
   tChannelID channelID;
   cList<cEvent> events;
   cHash<cEvent> eventsHashID;
   cHash<cEvent> eventsHashStartTime;
+  cVector<cEvent *> eventsByTime; // the events in the order of 'events', valid only after Sort()
+  bool eventsByTimeValid;
+  int maxDuration; // the longest duration of any event in this schedule
+  cEvent *runningEvent; // the event most recently set to 'running' by SetRunningStatus()
   mutable u_int16_t numTimers;// The number of timers that use this schedule
   bool hasRunning;
   int modified;
+  tChange changes[MAXSCHEDULECHANGES];
+  int numChanges;
+  int changesFrom; // the value of 'modified' before the oldest entry in 'changes'
+  time_t limitBegin, limitEnd; // see LimitModified()
   time_t presentSeen;
+  int FirstEventAfter(time_t Time) const;
+       ///< Returns the index into eventsByTime of the first event that starts after
+       ///< the given Time, or eventsByTime.Size() if there is no such event.
+  void IndexEvents(void);
+       ///< Rebuilds eventsByTime from the (sorted) list of events.
 public:
   cSchedule(tChannelID ChannelID);
   tChannelID ChannelID(void) const { return channelID; }
   bool Modified(int &State) const { bool Result = State != modified; State = modified; return Result; }
+  bool Modified(int &State, time_t Begin, time_t End) const;
+       ///< Like Modified(State), but only returns true if any events that overlap the
+       ///< time window [Begin, End] have been added, changed or deleted since State.
   time_t PresentSeen(void) const { return presentSeen; }
   bool PresentSeenWithin(int Seconds) const { return time(NULL) - presentSeen < Seconds; }
-  void SetModified(void) { modified++; }
+  void SetModified(void);
+  void LimitModified(time_t Begin, time_t End);
+       ///< Limits the changes reported by subsequent calls to SetModified() to the
+       ///< events that overlap the time window [Begin, End]. Calling LimitModified(0, 0)
+       ///< removes this limit again, so that SetModified() reports that any event may
+       ///< have been changed.
   void SetPresentSeen(void) { presentSeen = time(NULL); }
   void SetRunningStatus(cEvent *Event, int RunningStatus, const cChannel *Channel = NULL);
   void ClrRunningStatus(cChannel *Channel = NULL);
@@ -185,6 +216,12 @@ public:
   const cEvent *GetFollowingEvent(void) const;
   const cEvent *GetEvent(tEventID EventID, time_t StartTime = 0) const;
   const cEvent *GetEventAround(time_t Time) const;
+  const cEvent *GetEventEndingAfter(time_t Time) const;
+       ///< Returns the first event in Events() that ends after the given Time, or NULL
+       ///< if there is no such event.
+  int MaxDuration(void) const { return maxDuration; }
+       ///< Returns the duration of the longest event in this schedule. This is an
+       ///< upper limit, which may be larger than the actual longest duration.
   void Dump(const cChannels *Channels, FILE *f, const char *Prefix = "", eDumpMode DumpMode = dmAll, time_t AtTime = 0) const;
   static bool Read(FILE *f, cSchedules *Schedules);
   };
@@ -195,6 +232,14 @@ private:
   static cSchedules schedules;
   static char *epgDataFileName;
   static time_t lastDump;
+  static bool DumpSnapshot(void);
+       ///< Writes the EPG data to the epg.data file in the binary snapshot format.
+       ///< The data is copied into memory while the schedules are locked, and
+       ///< written to disk after the locks have been released.
+  static int ReadSnapshot(void);
+       ///< Reads the epg.data file if it is a binary snapshot. Returns 1 if the
+       ///< snapshot has been read, 0 if it was invalid, and -1 if the file is not
+       ///< a binary snapshot at all (i.e. it should be read as text).
 public:
   cSchedules(void);
   static const cSchedules *GetSchedulesRead(cStateKey &StateKey, int TimeoutMs = 0);
@@ -3328,6 +3328,7 @@ void cMenuSetupOSD::Set(void)
   Add(new cMenuEditIntItem( tr("Setup.OSD$Message time (s)"),       &data.OSDMessageTime, 1, 60));
   Add(new cMenuEditStraItem(tr("Setup.OSD$Use small font"),         &data.UseSmallFont, 3, useSmallFontTexts));
   Add(new cMenuEditBoolItem(tr("Setup.OSD$Anti-alias"),             &data.AntiAlias));
+  Add(new cMenuEditIntItem( tr("Setup.OSD$Render threads"),         &data.OSDRenderThreads, 1, MAXOSDRENDERTHREADS));
   Add(new cMenuEditStraItem(tr("Setup.OSD$Default font"),           &fontOsdIndex, fontOsdNames.Size(), &fontOsdNames[0]));
   Add(new cMenuEditStraItem(tr("Setup.OSD$Small font"),             &fontSmlIndex, fontSmlNames.Size(), &fontSmlNames[0]));
   Add(new cMenuEditStraItem(tr("Setup.OSD$Fixed font"),             &fontFixIndex, fontFixNames.Size(), &fontFixNames[0]));
@@ -3451,6 +3452,7 @@ void cMenuSetupEPG::Setup(void)
   Add(new cMenuEditIntItem( tr("Setup.EPG$EPG scan timeout (h)"),      &data.EPGScanTimeout));
   Add(new cMenuEditIntItem( tr("Setup.EPG$EPG bugfix level"),          &data.EPGBugfixLevel, 0, MAXEPGBUGFIXLEVEL));
   Add(new cMenuEditIntItem( tr("Setup.EPG$EPG linger time (min)"),     &data.EPGLinger, 0));
+  Add(new cMenuEditBoolItem(tr("Setup.EPG$Binary EPG data file"),      &data.EPGBinaryData));
   Add(new cMenuEditBoolItem(tr("Setup.EPG$Set system time"),           &data.SetSystemTime));
   if (data.SetSystemTime)
      Add(new cMenuEditTranItem(tr("Setup.EPG$Use time from transponder"), &data.TimeTransponder, &data.TimeSource));
@@ -3786,8 +3788,14 @@ bool cMenuSetupCAMItem::Changed(void)
      for (int i = 0; i < CardIndexes.Size(); i++)
          AssignedDevice = cString::sprintf("%s %d", *AssignedDevice, CardIndexes[i] + 1);
      }
+  cString MtdStatistics("");
+  if (camSlot->MtdActive()) {
+     MtdStatistics = camSlot->MtdStatistics();
+     if (**MtdStatistics)
+        MtdStatistics = cString::sprintf(" - %s%s", tr("MTD MB/s"), *MtdStatistics);
+     }
 
-  cString buffer = cString::sprintf(" %d %s%s%s", camSlot->SlotNumber(), CamName, *AssignedDevice, Activating);
+  cString buffer = cString::sprintf(" %d %s%s%s%s", camSlot->SlotNumber(), CamName, *AssignedDevice, Activating, *MtdStatistics);
   if (strcmp(buffer, Text()) != 0) {
      SetText(buffer);
      return true;
@@ -3978,6 +3986,7 @@ cMenuSetupRecord::cMenuSetupRecord(void)
   Add(new cMenuEditIntItem( tr("Setup.Recording$Max. video file size (MB)"), &data.MaxVideoFileSize, MINVIDEOFILESIZE, MAXVIDEOFILESIZETS));
   Add(new cMenuEditBoolItem(tr("Setup.Recording$Split edited files"),        &data.SplitEditedFiles));
   Add(new cMenuEditStraItem(tr("Setup.Recording$Delete timeshift recording"),&data.DelTimeshiftRec, 3, delTimeshiftRecTexts));
+  Add(new cMenuEditIntItem( tr("Setup.Recording$Scan threads"),              &data.RecordingScanThreads, 1, MAXRECORDINGSCANTHREADS));
 }
 
 // --- cMenuSetupReplay ------------------------------------------------------
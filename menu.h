@@ -251,6 +251,7 @@ public:
   const char *InstantId(void) { return instantId; }
   const char *FileName(void) { return fileName; }
   cTimer *Timer(void) { return timer; }
+  cRecorder *Recorder(void) { return recorder; }
   };
 
 class cRecordControls {
@@ -31,6 +31,17 @@
 
 // --- cMtdHandler -----------------------------------------------------------
 
+#define MTDSTATSMINTIME 1000 // ms, minimum time between two throughput calculations
+
+static inline int MtdIndex(int Pid)
+{
+#ifdef KEEPPIDS
+  return 0;
+#else
+  return (Pid >> UNIQ_PID_SHIFT) - 1;
+#endif // KEEPPIDS
+}
+
 cMtdHandler::cMtdHandler(void)
 {
 }
@@ -64,23 +75,24 @@ int cMtdHandler::Put(const uchar *Data, int Count)
         if (int Skipped = TS_SYNC(Data, Count))
            return Used + Skipped;
         int Pid = TsPid(Data);
-#ifdef KEEPPIDS
-        int Index = 0;
-#else
-        int Index = (Pid >> UNIQ_PID_SHIFT) - 1;
-#endif // KEEPPIDS
+        int Index = MtdIndex(Pid);
+        // Consecutive packets for the same MTD CAM slot are put in one go:
+        int Length = TS_SIZE;
+        while (Length + TS_SIZE <= Count && Data[Length] == TS_SYNC_BYTE && MtdIndex(TsPid(Data + Length)) == Index)
+              Length += TS_SIZE;
         if (Index >= 0 && Index < camSlots.Size()) {
-           int w = camSlots[Index]->PutData(Data, TS_SIZE);
-           if (w == 0)
-              break;
-           else if (w != TS_SIZE)
-              esyslog("ERROR: incomplete MTD packet written (%d) in PID %d (%04X)", Index + 1, Pid, Pid);
+           int w = camSlots[Index]->PutData(Data, Length);
+           if (w < Length) {
+              if (w % TS_SIZE)
+                 esyslog("ERROR: incomplete MTD packet written (%d) in PID %d (%04X)", Index + 1, Pid, Pid);
+              return Used + w;
+              }
            }
         else if (Index >= 0) // anything with Index -1 (i.e. MTD number 0) is either garbage or an actual CAT or EIT, which need not be returned to the device
            esyslog("ERROR: invalid MTD number (%d) in PID %d (%04X)", Index + 1, Pid, Pid);
-        Data += TS_SIZE;
-        Count -= TS_SIZE;
-        Used += TS_SIZE;
+        Data += Length;
+        Count -= Length;
+        Used += Length;
         }
   return Used;
 }
@@ -134,6 +146,26 @@ bool cMtdHandler::Devices(cVector<int> &CardIndexes)
   return CardIndexes.Size() > 0;
 }
 
+cString cMtdHandler::Statistics(void)
+{
+  int Elapsed = statsTimer.Elapsed();
+  bool Update = Elapsed >= MTDSTATSMINTIME;
+  if (Update)
+     statsTimer.Set();
+  cString s("");
+  for (int i = 0; i < camSlots.Size(); i++) {
+      cMtdCamSlot *MtdCamSlot = camSlots[i];
+      if (Update)
+         MtdCamSlot->UpdateThroughput(Elapsed);
+      if (cDevice *Device = MtdCamSlot->Device()) {
+         int Throughput = MtdCamSlot->Throughput();
+         int Overflows = MtdCamSlot->Overflows();
+         s = cString::sprintf("%s %d:%d.%d%s", *s, Device->CardIndex() + 1, Throughput / 10, Throughput % 10, Overflows ? *cString::sprintf("(%d)", Overflows) : "");
+         }
+      }
+  return s;
+}
+
 void cMtdHandler::UnAssignAll(void)
 {
   for (int i = 0; i < camSlots.Size(); i++)
@@ -155,6 +187,7 @@ private:
 public:
   cMtdMapper(int Number, int MasterCamSlotNumber);
   ~cMtdMapper();
+  int Number(void) { return number; }
   uint16_t RealToUniqPid(uint16_t RealPid) { if (uniqPids[RealPid]) return uniqPids[RealPid]; return MakeUniqPid(RealPid); }
   uint16_t UniqToRealPid(uint16_t UniqPid) { return realPids[UniqPid & UNIQ_PID_MASK]; }
   uint16_t RealToUniqSid(uint16_t RealSid);
@@ -235,6 +268,11 @@ cMtdCamSlot::cMtdCamSlot(cCamSlot *MasterSlot, int Index)
   mtdBuffer = new cRingBufferLinear(MTD_BUFFER_SIZE, TS_SIZE, true, "MTD buffer");
   mtdMapper = new cMtdMapper(Index + 1, MasterSlot->SlotNumber());
   delivered = false;
+  putBytes = 0;
+  lastPutBytes = 0;
+  throughput = 0;
+  overflows = 0;
+  stalled = false;
   ciAdapter = MasterSlot->ciAdapter; // we don't pass the CI adapter in the constructor, to prevent this one from being inserted into CamSlots
 }
 
@@ -288,6 +326,12 @@ void cMtdCamSlot::StopDecrypting(void)
   mtdMapper->Clear();
   mtdBuffer->Clear();
   delivered = false;
+  if (int64_t PutBytes = __atomic_exchange_n(&putBytes, 0, __ATOMIC_RELAXED))
+     dsyslog("CAM %d/%d: %d MB put into MTD buffer, %d overflows", MasterSlot()->SlotNumber(), mtdMapper->Number(), int(PutBytes / MEGABYTE(1)), overflows);
+  lastPutBytes = 0;
+  throughput = 0;
+  overflows = 0;
+  stalled = false;
 }
 
 uchar *cMtdCamSlot::Decrypt(uchar *Data, int &Count)
@@ -336,11 +380,29 @@ int cMtdCamSlot::PutData(const uchar *Data, int Count)
 {
   int Free = mtdBuffer->Free();
   Free -= Free % TS_SIZE;
-  if (Free < TS_SIZE)
-     return 0;
-  if (Free < Count)
+  if (Free < Count) {
+     // The caller offers the rejected packets again until they fit, so they are
+     // only counted when the buffer becomes full:
+     if (!stalled)
+        overflows += (Count - Free) / TS_SIZE;
+     stalled = true;
+     if (Free < TS_SIZE)
+        return 0;
      Count = Free;
-  return mtdBuffer->Put(Data, Count);
+     }
+  else
+     stalled = false;
+  Count = mtdBuffer->Put(Data, Count);
+  __atomic_add_fetch(&putBytes, Count, __ATOMIC_RELAXED);
+  return Count;
+}
+
+void cMtdCamSlot::UpdateThroughput(int Elapsed)
+{
+  int64_t PutBytes = __atomic_load_n(&putBytes, __ATOMIC_RELAXED);
+  if (Elapsed > 0 && PutBytes >= lastPutBytes)
+     throughput = int((PutBytes - lastPutBytes) * 10 * 1000 / Elapsed / MEGABYTE(1)); // 1/10 MB/s
+  lastPutBytes = PutBytes;
 }
 
 int cMtdCamSlot::PutCat(const uchar *Data, int Count)
@@ -111,6 +111,7 @@ mapped in cCiCaPmt::MtdMapPids().
 class cMtdHandler {
 private:
   cVector<cMtdCamSlot *> camSlots;
+  cTimeMs statsTimer;
 public:
   cMtdHandler(void);
       ///< Creates a new MTD handler that distributes TS data received through
@@ -140,6 +141,13 @@ public:
       ///< Adds the card indexes of the devices of any active MTD CAM slots to
       ///< the given CardIndexes.
       ///< Returns true if the array is not empty.
+  cString Statistics(void);
+      ///< Returns a string that contains the throughput (in MB/s) and the number
+      ///< of buffer overflows of every MTD CAM slot that is currently assigned to
+      ///< a device, in the form " <device>:<MB/s>(<overflows>)". The overflows are
+      ///< only given if there were any.
+      ///< The throughput is calculated from the amount of data put into each slot
+      ///< since the last call to this function (at most once per second).
   void UnAssignAll(void);
       ///< Unassigns all MTD CAM slots from their devices.
   };
@@ -157,6 +165,11 @@ private:
   cMtdMapper *mtdMapper;
   cRingBufferLinear *mtdBuffer;
   bool delivered;
+  int64_t putBytes;
+  int64_t lastPutBytes;
+  int throughput;
+  int overflows;
+  bool stalled; // the MTD buffer was full the last time PutData() was called
 protected:
   virtual const int *GetCaSystemIds(void);
   virtual void SendCaPmt(uint8_t CmdId);
@@ -174,6 +187,17 @@ public:
   virtual uchar *Decrypt(uchar *Data, int &Count);
   virtual void InjectEit(int Sid);
   int PutData(const uchar *Data, int Count);
+       ///< Puts at most Count bytes of Data (which must be a multiple of TS_SIZE)
+       ///< into this slot's MTD buffer. Returns the number of bytes actually stored.
+  void UpdateThroughput(int Elapsed);
+       ///< Calculates the throughput from the amount of data put into this slot
+       ///< during the last Elapsed milliseconds.
+  int Throughput(void) { return throughput; }
+       ///< Returns the throughput of this slot, in 1/10 MB/s.
+  int Overflows(void) { return overflows; }
+       ///< Returns the number of TS packets that could not be put into this slot
+       ///< because its MTD buffer was full. Packets that are offered again while the
+       ///< buffer is still full are only counted once.
   int PutCat(const uchar *Data, int Count);
   // The following functions shall not be called for a cMtdCamSlot:
   virtual cCamSlot *Spawn(void) { MTD_DONT_CALL(NULL); }
@@ -13,6 +13,9 @@
 #include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "device.h"
 #include "tools.h"
 
@@ -112,6 +115,141 @@ tColor AlphaBlend(tColor ColorFg, tColor ColorBg, uint8_t AlphaLayer)
 }
 #endif
 
+#ifdef USE_ALPHA_LUT
+// Returns the number of leading pixels in Data (at most Count) which's alpha value
+// is Alpha (which must be either 0x00 or 0xFF):
+static inline int AlphaRun(const tColor *Data, int Count, tColor Alpha)
+{
+  if ((*Data & 0xFF000000) != Alpha)
+     return 0;
+  int n = 1;
+#ifdef __SSE2__
+  __m128i m = _mm_set1_epi32(0xFF000000);
+  __m128i a = _mm_set1_epi32(Alpha);
+  while (n + 4 <= Count) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(Data + n));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(p, m), a)) != 0xFFFF)
+           break;
+        n += 4;
+        }
+#endif
+  while (n < Count && (Data[n] & 0xFF000000) == Alpha)
+        n++;
+  return n;
+}
+#endif
+
+#if defined(USE_ALPHA_LUT) && defined(__SSE2__)
+// Blends 4 pixels, with exactly the same result as AlphaBlend(). The factors are taken
+// from the lookup table, but the color components are blended with SSE2 (each one is
+// 'Fg * Factor0 + Bg * Factor1', which is what _mm_madd_epi16() computes):
+static inline void AlphaBlend4(tColor *Dst, const tColor *Src, uint8_t AlphaLayer)
+{
+  uint32_t f[4];
+  tColor a[4];
+  for (int i = 0; i < 4; i++) {
+      tColor Alpha = (((Src[i] & 0xFF000000) >> 24) * AlphaLayer) >> 8;
+      tColor AlphaBg = (Dst[i] & 0xFF000000) >> 24;
+      memcpy(&f[i], AlphaLutFactors[Alpha][AlphaBg], sizeof(f[i])); // Factor0 in the lower, Factor1 in the upper 16 bit
+      a[i] = AlphaLutAlpha[Alpha][AlphaBg] << 24;
+      }
+  __m128i z = _mm_setzero_si128();
+  __m128i F = _mm_loadu_si128((const __m128i *)f);
+  __m128i fg = _mm_loadu_si128((const __m128i *)Src);
+  __m128i bg = _mm_loadu_si128((const __m128i *)Dst);
+  __m128i fgl = _mm_unpacklo_epi8(fg, z);
+  __m128i bgl = _mm_unpacklo_epi8(bg, z);
+  __m128i fgh = _mm_unpackhi_epi8(fg, z);
+  __m128i bgh = _mm_unpackhi_epi8(bg, z);
+  __m128i p0 = _mm_srli_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(fgl, bgl), _mm_shuffle_epi32(F, 0x00)), 8);
+  __m128i p1 = _mm_srli_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(fgl, bgl), _mm_shuffle_epi32(F, 0x55)), 8);
+  __m128i p2 = _mm_srli_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(fgh, bgh), _mm_shuffle_epi32(F, 0xAA)), 8);
+  __m128i p3 = _mm_srli_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(fgh, bgh), _mm_shuffle_epi32(F, 0xFF)), 8);
+  __m128i c = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+  c = _mm_or_si128(_mm_and_si128(c, _mm_set1_epi32(0x00FFFFFF)), _mm_set_epi32(a[3], a[2], a[1], a[0]));
+  _mm_storeu_si128((__m128i *)Dst, c);
+}
+#endif
+
+void AlphaBlendRow(tColor *Dst, const tColor *Src, int Count, uint8_t AlphaLayer)
+{
+#ifdef USE_ALPHA_LUT
+  // With the lookup table, a fully opaque foreground pixel (at a fully opaque layer)
+  // always results in the foreground pixel itself, and a fully transparent one leaves
+  // the background pixel as it is (unless that is fully transparent, too, in which
+  // case the result is 0x00000000):
+  while (Count > 0) {
+        int n;
+        if (AlphaLayer == ALPHA_OPAQUE && (n = AlphaRun(Src, Count, 0xFF000000)) > 0)
+           memcpy(Dst, Src, n * sizeof(tColor));
+        else if ((n = AlphaRun(Src, Count, 0x00000000)) > 0) {
+           for (int i = 0; i < n; i++) {
+               if (!(Dst[i] & 0xFF000000))
+                  Dst[i] = 0x00000000;
+               }
+           }
+#ifdef __SSE2__
+        else if (Count >= 4) {
+           AlphaBlend4(Dst, Src, AlphaLayer);
+           n = 4;
+           }
+#endif
+        else {
+           *Dst = AlphaBlend(*Src, *Dst, AlphaLayer);
+           n = 1;
+           }
+        Src += n;
+        Dst += n;
+        Count -= n;
+        }
+#else
+  while (Count-- > 0) {
+        *Dst = AlphaBlend(*Src++, *Dst, AlphaLayer);
+        Dst++;
+        }
+#endif
+}
+
+//#define DebugAlphaBlendRow
+#ifdef DebugAlphaBlendRow
+// Compares the results of AlphaBlendRow() with those of AlphaBlend() for random rows and
+// alpha values when VDR starts (must be defined after InitAlphaLut):
+class cCheckAlphaBlendRow {
+private:
+  static tColor Random(void)
+  {
+    tColor Color = (tColor(rand()) << 16) ^ rand();
+    switch (rand() % 4) {
+      case 0: return Color | 0xFF000000;
+      case 1: return Color & 0x00FFFFFF;
+      default: return Color;
+      }
+  }
+public:
+  cCheckAlphaBlendRow(void)
+  {
+    const int MaxPixels = 1920;
+    tColor Src[MaxPixels], Dst[MaxPixels], Ref[MaxPixels];
+    int Errors = 0;
+    for (int t = 0; t < 10000; t++) {
+        int Count = 1 + rand() % MaxPixels;
+        int Run = 1 + rand() % 20; // typical pixmaps contain runs of identical pixels
+        for (int i = 0; i < Count; i++) {
+            Src[i] = (i % Run) ? Src[i - 1] : Random();
+            Dst[i] = Ref[i] = Random();
+            }
+        uint8_t AlphaLayer = (rand() % 2) ? ALPHA_OPAQUE : rand() % 256;
+        AlphaBlendRow(Dst, Src, Count, AlphaLayer);
+        for (int i = 0; i < Count; i++)
+            Ref[i] = AlphaBlend(Src[i], Ref[i], AlphaLayer);
+        if (memcmp(Dst, Ref, Count * sizeof(tColor)) != 0)
+           Errors++;
+        }
+    fprintf(stderr, "AlphaBlendRow: %d errors\n", Errors);
+  }
+  } CheckAlphaBlendRow;
+#endif
+
 // --- cPalette --------------------------------------------------------------
 
 cPalette::cPalette(int Bpp)
@@ -953,6 +1091,75 @@ void cRect::Combine(const cPoint &Point)
   SetTop(min(Top(), Point.Y()));
 }
 
+// --- cDirtyArea ------------------------------------------------------------
+
+// Two rectangles are combined if the combined rectangle is no more than this
+// percentage larger than the two of them:
+#define DIRTYAREAWASTE  25 // %
+
+static inline int RectArea(const cRect &Rect)
+{
+  return Rect.Width() * Rect.Height();
+}
+
+void cDirtyArea::Remove(int Index)
+{
+  rects[Index] = rects[--numRects];
+}
+
+void cDirtyArea::Add(const cRect &Rect)
+{
+  if (Rect.IsEmpty())
+     return;
+  cRect r = Rect;
+  for (int i = 0; i < numRects; i++) {
+      if (rects[i].Contains(r))
+         return;
+      }
+  // Combine r with every rectangle it intersects (or that is close enough), until
+  // there are no more such rectangles:
+  for (int i = 0; i < numRects; ) {
+      if (r.Intersects(rects[i]) || RectArea(r.Combined(rects[i])) * 100 <= (RectArea(r) + RectArea(rects[i])) * (100 + DIRTYAREAWASTE)) {
+         r.Combine(rects[i]);
+         Remove(i);
+         i = 0;
+         }
+      else
+         i++;
+      }
+  if (numRects >= MAXDIRTYRECTS) {
+     // Combine r with the rectangle that results in the smallest growth:
+     int Best = 0;
+     int BestGrowth = INT_MAX;
+     for (int i = 0; i < numRects; i++) {
+         cRect c = r.Combined(rects[i]);
+         int Growth = RectArea(c) - RectArea(rects[i]) - RectArea(r);
+         if (Growth < BestGrowth) {
+            Best = i;
+            BestGrowth = Growth;
+            }
+         }
+     r.Combine(rects[Best]);
+     Remove(Best);
+     Add(r); // r may now intersect other rectangles
+     return;
+     }
+  rects[numRects++] = r;
+}
+
+void cDirtyArea::Add(const cDirtyArea &Area)
+{
+  for (int i = 0; i < Area.numRects; i++)
+      Add(Area.rects[i]);
+}
+
+cRect cDirtyArea::Take(void)
+{
+  if (numRects > 0)
+     return rects[--numRects];
+  return cRect();
+}
+
 // --- cPixmap ---------------------------------------------------------------
 
 cMutex cPixmap::mutex;
@@ -984,14 +1191,19 @@ cPixmap::cPixmap(int Layer, const cRect &ViewPort, const cRect &DrawPort)
 
 void cPixmap::MarkViewPortDirty(const cRect &Rect)
 {
-  if (layer >= 0)
-     dirtyViewPort.Combine(Rect.Intersected(viewPort));
+  if (layer >= 0) {
+     cRect r = Rect.Intersected(viewPort);
+     dirtyViewPort.Combine(r);
+     dirtyArea.Add(r);
+     }
 }
 
 void cPixmap::MarkViewPortDirty(const cPoint &Point)
 {
-  if (layer >= 0 && viewPort.Contains(Point))
+  if (layer >= 0 && viewPort.Contains(Point)) {
      dirtyViewPort.Combine(Point);
+     dirtyArea.Add(cRect(Point, cSize(1, 1)));
+     }
 }
 
 void cPixmap::MarkDrawPortDirty(const cRect &Rect)
@@ -1017,6 +1229,7 @@ void cPixmap::MarkDrawPortDirty(const cPoint &Point)
 void cPixmap::SetClean(void)
 {
   dirtyViewPort = dirtyDrawPort = cRect();
+  dirtyArea.Clear();
 }
 
 void cPixmap::SetLayer(int Layer)
@@ -1143,6 +1356,7 @@ cPixmapMemory::cPixmapMemory(void)
 {
   data = NULL;
   panning = false;
+  concurrent = false;
 }
 
 cPixmapMemory::cPixmapMemory(int Layer, const cRect &ViewPort, const cRect &DrawPort)
@@ -1150,6 +1364,7 @@ cPixmapMemory::cPixmapMemory(int Layer, const cRect &ViewPort, const cRect &Draw
 {
   data = MALLOC(tColor, this->DrawPort().Width() * this->DrawPort().Height());
   panning = false;
+  concurrent = false;
 }
 
 cPixmapMemory::~cPixmapMemory()
@@ -1520,7 +1735,8 @@ void cPixmapMemory::DrawSlope(const cRect &Rect, tColor Color, int Type)
 
 void cPixmapMemory::Render(const cPixmap *Pixmap, const cRect &Source, const cPoint &Dest)
 {
-  Lock();
+  if (!concurrent)
+     Lock();
   if (Pixmap->Alpha() != ALPHA_TRANSPARENT) {
      if (const cPixmapMemory *pm = dynamic_cast<const cPixmapMemory *>(Pixmap)) {
         cRect s = Source.Intersected(Pixmap->DrawPort().Size());
@@ -1535,27 +1751,24 @@ void cPixmapMemory::Render(const cPixmap *Pixmap, const cRect &Source, const cPo
               const tColor *ps = pm->data + ws * s.Top() + s.Left();
               tColor *pd = data + wd * d.Top() + d.Left();
               for (int y = d.Height(); y-- > 0; ) {
-                  const tColor *cs = ps;
-                  tColor *cd = pd;
-                  for (int x = d.Width(); x-- > 0; ) {
-                      *cd = AlphaBlend(*cs, *cd, a);
-                      cs++;
-                      cd++;
-                      }
+                  AlphaBlendRow(pd, ps, d.Width(), a);
                   ps += ws;
                   pd += wd;
                   }
-              MarkDrawPortDirty(d);
+              if (!concurrent)
+                 MarkDrawPortDirty(d);
               }
            }
         }
      }
-  Unlock();
+  if (!concurrent)
+     Unlock();
 }
 
 void cPixmapMemory::Copy(const cPixmap *Pixmap, const cRect &Source, const cPoint &Dest)
 {
-  Lock();
+  if (!concurrent)
+     Lock();
   if (const cPixmapMemory *pm = dynamic_cast<const cPixmapMemory *>(Pixmap)) {
      cRect s = Source.Intersected(pm->DrawPort().Size());
      if (!s.IsEmpty()) {
@@ -1573,11 +1786,13 @@ void cPixmapMemory::Copy(const cPixmap *Pixmap, const cRect &Source, const cPoin
                ps += ws;
                pd += wd;
                }
-           MarkDrawPortDirty(d);
+           if (!concurrent)
+              MarkDrawPortDirty(d);
            }
         }
      }
-  Unlock();
+  if (!concurrent)
+     Unlock();
 }
 
 void cPixmapMemory::Scroll(const cPoint &Dest, const cRect &Source)
@@ -1623,6 +1838,127 @@ void cPixmapMemory::Pan(const cPoint &Dest, const cRect &Source)
   Unlock();
 }
 
+// --- cOsdTileRenderer ------------------------------------------------------
+
+#define MINTILEHEIGHT   32 // pixel rows
+#define MINTILEDAREA    (256 * 256) // pixels, smaller rectangles are rendered in one go
+
+class cOsdTileRenderer;
+
+class cOsdTileWorker : public cThread {
+private:
+  cOsdTileRenderer *renderer;
+protected:
+  virtual void Action(void);
+public:
+  cOsdTileWorker(cOsdTileRenderer *Renderer);
+  virtual ~cOsdTileWorker();
+  };
+
+class cOsdTileRenderer {
+  friend class cOsdTileWorker;
+private:
+  cMutex mutex;
+  cCondVar tilesAvailable;
+  cCondVar tilesDone;
+  cVector<cOsdTileWorker *> workers;
+  cOsd *osd;
+  cPixmap *pixmap;
+  cRect rect;
+  int tileHeight;
+  int numTiles;
+  int nextTile;
+  int doneTiles;
+  bool stop;
+  bool RenderNextTile(void);
+       ///< Renders the next tile that hasn't been taken by any other thread yet.
+       ///< Must be called with mutex locked.
+       ///< Returns false if there are no more tiles to render.
+public:
+  cOsdTileRenderer(int NumThreads);
+  ~cOsdTileRenderer();
+  int NumThreads(void) { return workers.Size() + 1; }
+  void Render(cOsd *Osd, cPixmap *Pixmap, const cRect &Rect);
+       ///< Renders the given Rect of Osd into Pixmap, using the calling thread
+       ///< as well as all worker threads. Returns when all tiles are done.
+  };
+
+static cOsdTileRenderer *OsdTileRenderer = NULL;
+
+cOsdTileWorker::cOsdTileWorker(cOsdTileRenderer *Renderer)
+:cThread("osd tile renderer")
+{
+  renderer = Renderer;
+  Start();
+}
+
+cOsdTileWorker::~cOsdTileWorker()
+{
+  Cancel(3);
+}
+
+void cOsdTileWorker::Action(void)
+{
+  cMutexLock MutexLock(&renderer->mutex);
+  while (!renderer->stop) {
+        if (!renderer->RenderNextTile())
+           renderer->tilesAvailable.Wait(renderer->mutex);
+        }
+}
+
+cOsdTileRenderer::cOsdTileRenderer(int NumThreads)
+{
+  osd = NULL;
+  pixmap = NULL;
+  tileHeight = numTiles = nextTile = doneTiles = 0;
+  stop = false;
+  for (int i = 1; i < NumThreads; i++)
+      workers.Append(new cOsdTileWorker(this));
+}
+
+cOsdTileRenderer::~cOsdTileRenderer()
+{
+  mutex.Lock();
+  stop = true;
+  tilesAvailable.Broadcast();
+  mutex.Unlock();
+  for (int i = 0; i < workers.Size(); i++)
+      delete workers[i];
+}
+
+bool cOsdTileRenderer::RenderNextTile(void)
+{
+  if (nextTile >= numTiles)
+     return false;
+  int Top = rect.Top() + nextTile++ * tileHeight;
+  cRect Tile(rect.Left(), Top, rect.Width(), min(tileHeight, rect.Bottom() - Top + 1));
+  mutex.Unlock();
+  osd->RenderLayers(pixmap, Tile);
+  mutex.Lock();
+  if (++doneTiles == numTiles)
+     tilesDone.Broadcast();
+  return true;
+}
+
+void cOsdTileRenderer::Render(cOsd *Osd, cPixmap *Pixmap, const cRect &Rect)
+{
+  cMutexLock MutexLock(&mutex);
+  osd = Osd;
+  pixmap = Pixmap;
+  rect = Rect;
+  // Use more tiles than threads, so that they finish at about the same time:
+  tileHeight = max(MINTILEHEIGHT, (Rect.Height() + 2 * NumThreads() - 1) / (2 * NumThreads()));
+  numTiles = (Rect.Height() + tileHeight - 1) / tileHeight;
+  nextTile = doneTiles = 0;
+  tilesAvailable.Broadcast();
+  while (RenderNextTile())
+        ;
+  while (doneTiles < numTiles)
+        tilesDone.Wait(mutex);
+  osd = NULL;
+  pixmap = NULL;
+}
+
 // --- cOsd ------------------------------------------------------------------
 
 static const char *OsdErrorTexts[] = {
@@ -1753,23 +2089,36 @@ cPixmap *cOsd::AddPixmap(cPixmap *Pixmap)
   return Pixmap;
 }
 
+void cOsd::RenderLayers(cPixmap *Pixmap, const cRect &Rect)
+{
+  for (int Layer = 0; Layer < MAXPIXMAPLAYERS; Layer++) {
+      for (int i = 0; i < pixmaps.Size(); i++) {
+          if (cPixmap *pm = pixmaps[i]) {
+             if (pm->Layer() == Layer)
+                Pixmap->DrawPixmap(pm, Rect);
+             }
+          }
+      }
+}
+
 cPixmap *cOsd::RenderPixmaps(void)
 {
   cPixmap *Pixmap = NULL;
   if (isTrueColor) {
      LOCK_PIXMAPS;
-     // Collect overlapping dirty rectangles:
-     cRect d;
-     for (int i = 0; i < pixmaps.Size(); i++) {
-         if (cPixmap *pm = pixmaps[i]) {
-            if (!pm->DirtyViewPort().IsEmpty()) {
-               if (d.IsEmpty() || d.Intersects(pm->DirtyViewPort())) {
-                  d.Combine(pm->DirtyViewPort());
+     if (dirtyArea.IsEmpty()) {
+        // Collect the dirty rectangles of all pixmaps:
+        for (int i = 0; i < pixmaps.Size(); i++) {
+            if (cPixmap *pm = pixmaps[i]) {
+               if (!pm->DirtyViewPort().IsEmpty()) {
+                  dirtyArea.Add(pm->DirtyArea());
                   pm->SetClean();
                   }
                }
             }
-         }
+        }
+     // Each call renders one of the collected rectangles:
+     cRect d = dirtyArea.Take();
      if (!d.IsEmpty()) {
 //#define DebugDirty
 #ifdef DebugDirty
@@ -1782,14 +2131,20 @@ cPixmap *cOsd::RenderPixmaps(void)
         if (Pixmap) {
            Pixmap->Clear();
            // Render the individual pixmaps into the resulting pixmap:
-           for (int Layer = 0; Layer < MAXPIXMAPLAYERS; Layer++) {
-               for (int i = 0; i < pixmaps.Size(); i++) {
-                   if (cPixmap *pm = pixmaps[i]) {
-                      if (pm->Layer() == Layer)
-                         Pixmap->DrawPixmap(pm, d);
-                      }
-                   }
-               }
+           cPixmapMemory *pm = dynamic_cast<cPixmapMemory *>(Pixmap);
+           int Threads = min(Setup.OSDRenderThreads, MAXOSDRENDERTHREADS);
+           if (pm && Threads > 1 && d.Width() * d.Height() >= MINTILEDAREA && d.Height() >= 2 * MINTILEHEIGHT) {
+              if (!OsdTileRenderer || OsdTileRenderer->NumThreads() != Threads) {
+                 delete OsdTileRenderer;
+                 OsdTileRenderer = new cOsdTileRenderer(Threads);
+                 }
+              pm->SetConcurrent(true);
+              OsdTileRenderer->Render(this, pm, d);
+              pm->SetConcurrent(false);
+              pm->MarkDrawPortDirty(pm->DrawPort()); // the tiles don't do this themselves
+              }
+           else
+              RenderLayers(Pixmap, d);
 #ifdef DebugDirty
            cPixmapMemory DirtyIndicator(7, NewDirty);
            static tColor DirtyIndicatorColors[] = { 0x7FFFFF00, 0x7F00FFFF };
@@ -2123,6 +2478,8 @@ void cOsdProvider::Shutdown(void)
 {
   delete osdProvider;
   osdProvider = NULL;
+  delete OsdTileRenderer;
+  OsdTileRenderer = NULL;
 }
 
 // --- cTextScroller ---------------------------------------------------------
@@ -85,6 +85,12 @@ tColor HsvToColor(double H, double S, double V);
 
 tColor AlphaBlend(tColor ColorFg, tColor ColorBg, uint8_t AlphaLayer = ALPHA_OPAQUE);
 
+void AlphaBlendRow(tColor *Dst, const tColor *Src, int Count, uint8_t AlphaLayer = ALPHA_OPAQUE);
+   ///< Blends Count pixels from Src onto Dst, with exactly the same result as calling
+   ///< Dst[i] = AlphaBlend(Src[i], Dst[i], AlphaLayer) for each of them. Runs of fully
+   ///< opaque or fully transparent pixels are handled in one go, so this is much faster
+   ///< than blending pixel by pixel when rendering typical OSD pixmaps.
+
 class cPalette {
 private:
   tColor color[MAXNUMCOLORS];
@@ -416,6 +422,32 @@ public:
        ///< Returns true if this rectangle is empty.
   };
 
+#define MAXDIRTYRECTS  8 // the maximum number of rectangles in a cDirtyArea
+
+class cDirtyArea {
+private:
+  cRect rects[MAXDIRTYRECTS];
+  int numRects;
+  void Remove(int Index);
+public:
+  cDirtyArea(void) { numRects = 0; }
+  void Add(const cRect &Rect);
+       ///< Adds the given Rect to this area. The rectangles of an area never
+       ///< overlap. If Rect intersects an existing rectangle, or if combining them
+       ///< would cover only little more than the two of them, they are combined
+       ///< into one. If there are already MAXDIRTYRECTS rectangles, Rect is combined
+       ///< with the one that results in the smallest growth.
+  void Add(const cDirtyArea &Area);
+       ///< Adds all rectangles of the given Area to this area.
+  cRect Take(void);
+       ///< Removes one of the rectangles from this area and returns it.
+       ///< If the area is empty, an empty rectangle is returned.
+  void Clear(void) { numRects = 0; }
+  bool IsEmpty(void) const { return numRects == 0; }
+  int NumRects(void) const { return numRects; }
+  const cRect &Rect(int Index) const { return rects[Index]; }
+  };
+
 class cImage {
 private:
   cSize size;
@@ -463,11 +495,13 @@ private:
   cRect drawPort;
   cRect dirtyViewPort;
   cRect dirtyDrawPort;
+  cDirtyArea dirtyArea;
 protected:
   virtual ~cPixmap() {}
   void MarkViewPortDirty(const cRect &Rect);
        ///< Marks the given rectangle of the view port of this pixmap as dirty.
-       ///< Rect is combined with the existing dirtyViewPort rectangle.
+       ///< Rect is combined with the existing dirtyViewPort rectangle, and added
+       ///< to the DirtyArea().
        ///< The coordinates of Rect are given in absolute OSD values.
   void MarkViewPortDirty(const cPoint &Point);
        ///< Marks the given point of the view port of this pixmap as dirty.
@@ -551,6 +585,13 @@ public:
        ///< relative to the OSD's origin.
        ///< Since this function returns a reference to a data member, the caller must
        ///< use Lock()/Unlock() to make sure the data doesn't change while it is used.
+  const cDirtyArea &DirtyArea(void) const { return dirtyArea; }
+       ///< Returns the "dirty" area this pixmap causes on the OSD, as a list of
+       ///< non-overlapping rectangles. They all lie within DirtyViewPort(), but
+       ///< don't necessarily cover all of it. The rectangles are relative to the
+       ///< OSD's origin.
+       ///< Since this function returns a reference to a data member, the caller must
+       ///< use Lock()/Unlock() to make sure the data doesn't change while it is used.
   const cRect &DirtyDrawPort(void) const { return dirtyDrawPort; }
        ///< Returns the "dirty" rectangle in the draw port of this this pixmap. This is
        ///< the surrounding rectangle around all pixels that have been modified since the
@@ -684,9 +725,16 @@ public:
 // values to store the pixmap.
 
 class cPixmapMemory : public cPixmap {
+  friend class cOsd;
 private:
   tColor *data;
   bool panning;
+  bool concurrent;
+  void SetConcurrent(bool On) { concurrent = On; }
+       ///< If On is true, Copy() and Render() neither lock the pixmap mutex nor mark
+       ///< the draw port as dirty, so that several threads can render into distinct
+       ///< parts of this pixmap at the same time (see cOsd::RenderPixmaps()). The
+       ///< caller must hold the lock on the pixmap mutex while they do so.
 public:
   cPixmapMemory(void);
   cPixmapMemory(int Layer, const cRect &ViewPort, const cRect &DrawPort = cRect::Null);
@@ -709,6 +757,7 @@ public:
   };
 
 #define MAXOSDAREAS 16
+#define MAXOSDRENDERTHREADS 16
 
 /// The cOsd class is the interface to the "On Screen Display".
 /// An actual output device needs to derive from this class and implement
@@ -723,6 +772,7 @@ public:
 
 class cOsd {
   friend class cOsdProvider;
+  friend class cOsdTileRenderer;
 private:
   static int osdLeft, osdTop, osdWidth, osdHeight;
   static cVector<cOsd *> Osds;
@@ -734,9 +784,13 @@ private:
   int numBitmaps;
   cPixmapMemory *savedPixmap;
   cVector<cPixmap *> pixmaps;
+  cDirtyArea dirtyArea;
   int left, top, width, height;
   uint level;
   bool active;
+  void RenderLayers(cPixmap *Pixmap, const cRect &Rect);
+       ///< Renders the given Rect of all pixmaps of this OSD (in the order of their
+       ///< layers) into Pixmap.
 protected:
   cOsd(int Left, int Top, uint Level);
        ///< Initializes the OSD with the given coordinates.
@@ -775,13 +829,15 @@ protected:
        ///< refreshed; its draw port's origin is at (0, 0), and it has the same
        ///< size as the view port.
        ///< Only pixmaps with a non-negative layer value are rendered.
-       ///< If there are several non-overlapping dirty rectangles from different pixmaps,
-       ///< they are returned separately in order to avoid re-rendering large parts
-       ///< of the OSD that haven't changed at all. The caller must therefore call
+       ///< If there are several non-overlapping dirty rectangles (from the same or
+       ///< different pixmaps), they are returned separately in order to avoid
+       ///< re-rendering large parts of the OSD that haven't changed at all. The caller must therefore call
        ///< RenderPixmaps() repeatedly until it returns NULL, and display the returned
        ///< parts of the OSD at their appropriate locations. During this entire
        ///< operation the caller must hold a lock on the cPixmap mutex (for instance
        ///< by putting a LOCK_PIXMAPS into the scope of the operation).
+       ///< If Setup.OSDRenderThreads is greater than 1, larger rectangles are split
+       ///< into horizontal tiles that are rendered in parallel by that many threads.
        ///< If there are no dirty pixmaps, or if this is not a true color OSD,
        ///< this function returns NULL.
        ///< The caller must call DestroyPixmap() for the returned pixmap after use.
@@ -42,11 +42,17 @@ void cReceiver::SetPriority(int Priority)
 bool cReceiver::AddPid(int Pid)
 {
   if (Pid) {
+     if (Pid < 0 || Pid >= MAXPID) {
+        esyslog("ERROR: invalid PID %d in cReceiver", Pid);
+        return false;
+        }
      if (numPids < MAXRECEIVEPIDS) {
         if (!WantsPid(Pid)) {
            pids[numPids++] = Pid;
-           if (device)
+           if (device) {
               device->AddPid(Pid);
+              device->SetReceiverPid(this, Pid, true);
+              }
            }
         }
      else {
@@ -75,6 +81,10 @@ bool cReceiver::AddPids(int Pid1, int Pid2, int Pid3, int Pid4, int Pid5, int Pi
 
 bool cReceiver::SetPids(const cChannel *Channel)
 {
+  if (device) {
+     for (int i = 0; i < numPids; i++)
+         device->SetReceiverPid(this, pids[i], false);
+     }
   numPids = 0;
   if (Channel) {
      channelID = Channel->GetChannelID();
@@ -95,8 +105,10 @@ void cReceiver::DelPid(int Pid)
             for ( ; i < numPids; i++) // we also copy the terminating 0!
                 pids[i] = pids[i + 1];
             numPids--;
-            if (device)
+            if (device) {
+               device->SetReceiverPid(this, Pid, false);
                device->DelPid(Pid);
+               }
             return;
             }
          }
@@ -122,6 +134,12 @@ bool cReceiver::WantsPid(int Pid)
   return false;
 }
 
+void cReceiver::ReceivePackets(const uchar *Data, int Length)
+{
+  for (int i = 0; i + TS_SIZE <= Length; i += TS_SIZE)
+      Receive(Data + i, TS_SIZE);
+}
+
 void cReceiver::Detach(void)
 {
   if (device)
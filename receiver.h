@@ -43,6 +43,14 @@ protected:
                ///< as soon as possible, without any unnecessary delay. Each TS packet
                ///< will be delivered only ONCE, so the cReceiver must make sure that
                ///< it will be able to buffer the data if necessary.
+  virtual void ReceivePackets(const uchar *Data, int Length);
+               ///< This function is called from the cDevice we are attached to, and
+               ///< delivers a contiguous run of Length / TS_SIZE TS packets from the set
+               ///< of PIDs the cReceiver has requested. The same rules as for Receive()
+               ///< apply. The default implementation calls Receive() for each individual
+               ///< TS packet. A derived class that can handle several TS packets at once
+               ///< (for instance by simply putting them into a ring buffer) may reimplement
+               ///< this function to avoid the overhead of one function call per packet.
 public:
   cReceiver(const cChannel *Channel = NULL, int Priority = MINPRIORITY);
                ///< Creates a new receiver for the given Channel with the given Priority.
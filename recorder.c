@@ -19,11 +19,16 @@
 #define MINFREEDISKSPACE    (512) // MB
 #define DISKCHECKINTERVAL   100 // seconds
 
+// TS data (including PAT/PMT) is collected and written to disk in larger chunks:
+#define RECORDERWRITESIZE   KILOBYTE(512) // bytes
+#define RECORDERWRITEDELAY  500 // ms, max. time data is held back before it is written
+
 // --- cRecorder -------------------------------------------------------------
 
 cRecorder::cRecorder(const char *FileName, const cChannel *Channel, int Priority)
 :cReceiver(Channel, Priority)
 ,cThread("recording")
+,writeBuffer(RECORDERWRITESIZE + MEGABYTE(1))
 {
   recordingName = strdup(FileName);
 
@@ -31,7 +36,7 @@ cRecorder::cRecorder(const char *FileName, const cChannel *Channel, int Priority
 
   SpinUpDisk(FileName);
 
-  ringBuffer = new cRingBufferLinear(RECORDERBUFSIZE, MIN_TS_PACKETS_FOR_FRAME_DETECTOR * TS_SIZE, true, "Recorder");
+  ringBuffer = new cRingBufferLinear(RECORDERBUFSIZE, MIN_TS_PACKETS_FOR_FRAME_DETECTOR * TS_SIZE, true, "Recorder", true);
   ringBuffer->SetTimeouts(0, 100);
   ringBuffer->SetIoThrottle();
 
@@ -49,6 +54,10 @@ cRecorder::cRecorder(const char *FileName, const cChannel *Channel, int Priority
   index = NULL;
   fileSize = 0;
   lastDiskSpaceCheck = time(NULL);
+  writes = 0;
+  writtenBytes = 0;
+  writeTime = 0;
+  maxWriteTime = 0;
   fileName = new cFileName(FileName, true);
   int PatVersion, PmtVersion;
   if (fileName->GetLastPatPmtVersions(PatVersion, PmtVersion))
@@ -67,6 +76,11 @@ cRecorder::cRecorder(const char *FileName, const cChannel *Channel, int Priority
 cRecorder::~cRecorder()
 {
   Detach();
+  int Writes, AvgTime, MaxTime;
+  int64_t Bytes;
+  GetWriteStatistics(Writes, Bytes, AvgTime, MaxTime);
+  if (Writes)
+     dsyslog("recording '%s': %d writes, avg. %d KB, avg. %d ms, max. %d ms", recordingName, Writes, int(Bytes / Writes / KILOBYTE(1)), AvgTime, MaxTime);
   delete index;
   delete fileName;
   delete frameDetector;
@@ -91,6 +105,8 @@ bool cRecorder::NextFile(void)
 {
   if (recordFile && frameDetector->IndependentFrame()) { // every file shall start with an independent frame
      if (fileSize > MEGABYTE(off_t(Setup.MaxVideoFileSize)) || RunningLowOnDiskSpace()) {
+        if (!Flush())
+           return false;
         recordFile = fileName->NextFile();
         fileSize = 0;
         }
@@ -98,6 +114,49 @@ bool cRecorder::NextFile(void)
   return recordFile != NULL;
 }
 
+bool cRecorder::Flush(void)
+{
+  if (writeBuffer.Length()) {
+     if (!recordFile) {
+        // the error has already been logged when opening the file
+        if (index)
+           index->Discard();
+        writeBuffer.Clear();
+        return false;
+        }
+     cTimeMs t;
+     if (recordFile->Write(writeBuffer.Data(), writeBuffer.Length()) < 0) {
+        LOG_ERROR_STR(fileName->Name());
+        // The index entries must not refer to data that hasn't been written, and the
+        // data must not be written later on without its index entries:
+        if (index)
+           index->Discard();
+        writeBuffer.Clear();
+        return false;
+        }
+     int Elapsed = int(t.Elapsed());
+     cMutexLock MutexLock(&statisticsMutex);
+     writes++;
+     writtenBytes += writeBuffer.Length();
+     writeTime += Elapsed;
+     maxWriteTime = max(maxWriteTime, Elapsed);
+     writeBuffer.Clear();
+     }
+  lastFlush.Set(RECORDERWRITEDELAY);
+  if (index)
+     index->Flush();
+  return true;
+}
+
+void cRecorder::GetWriteStatistics(int &Writes, int64_t &Bytes, int &AvgTime, int &MaxTime)
+{
+  cMutexLock MutexLock(&statisticsMutex);
+  Writes = writes;
+  Bytes = writtenBytes;
+  AvgTime = writes ? int(writeTime / writes) : 0;
+  MaxTime = maxWriteTime;
+}
+
 void cRecorder::Activate(bool On)
 {
   if (On)
@@ -106,30 +165,37 @@ void cRecorder::Activate(bool On)
      Cancel(3);
 }
 
+static const uchar AdaptationFieldFiller[TS_SIZE - 4] = { 0xB7, 0x00,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF};
+
+static inline bool IsAdaptationFieldFiller(const uchar *Data)
+{
+  return (Data[3] & 0b00110000) == 0b00100000 && !memcmp(Data + 4, AdaptationFieldFiller, sizeof(AdaptationFieldFiller));
+}
+
 void cRecorder::Receive(const uchar *Data, int Length)
 {
   if (Running()) {
-     static const uchar aff[TS_SIZE - 4] = { 0xB7, 0x00,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-       0xFF, 0xFF}; // Length is always TS_SIZE!
-     if ((Data[3] & 0b00110000) == 0b00100000 && !memcmp(Data + 4, aff, sizeof(aff)))
+     // Length is always TS_SIZE!
+     if (IsAdaptationFieldFiller(Data))
         return; // Adaptation Field Filler found, skipping
      int p = ringBuffer->Put(Data, Length);
      if (p != Length && Running())
@@ -137,6 +203,24 @@ void cRecorder::Receive(const uchar *Data, int Length)
      }
 }
 
+void cRecorder::ReceivePackets(const uchar *Data, int Length)
+{
+  if (Running()) {
+     // Put runs of packets into the ring buffer in one go, skipping any Adaptation Field Fillers:
+     int Start = 0;
+     for (int i = 0; i <= Length; i += TS_SIZE) {
+         if (i == Length || IsAdaptationFieldFiller(Data + i)) {
+            if (int Count = i - Start) {
+               int p = ringBuffer->Put(Data + Start, Count);
+               if (p != Count && Running())
+                  ringBuffer->ReportOverflow(Count - p);
+               }
+            Start = i + TS_SIZE;
+            }
+         }
+     }
+}
+
 void cRecorder::Action(void)
 {
   cTimeMs t(MAXBROKENTIMEOUT);
@@ -171,20 +255,21 @@ void cRecorder::Action(void)
                     if (index && frameDetector->NewFrame())
                        index->Write(frameDetector->IndependentFrame(), fileName->Number(), fileSize);
                     if (frameDetector->IndependentFrame()) {
-                       recordFile->Write(patPmtGenerator.GetPat(), TS_SIZE);
+                       writeBuffer.Append(patPmtGenerator.GetPat(), TS_SIZE);
                        fileSize += TS_SIZE;
                        int Index = 0;
                        while (uchar *pmt = patPmtGenerator.GetPmt(Index)) {
-                             recordFile->Write(pmt, TS_SIZE);
+                             writeBuffer.Append(pmt, TS_SIZE);
                              fileSize += TS_SIZE;
                              }
                        t.Set(MAXBROKENTIMEOUT);
                        }
-                    if (recordFile->Write(b, Count) < 0) {
-                       LOG_ERROR_STR(fileName->Name());
-                       break;
-                       }
+                    writeBuffer.Append(b, Count);
                     fileSize += Count;
+                    if (writeBuffer.Length() >= RECORDERWRITESIZE || lastFlush.TimedOut()) {
+                       if (!Flush())
+                          break;
+                       }
                     }
                  }
               ringBuffer->Del(Count);
@@ -196,4 +281,5 @@ void cRecorder::Action(void)
            t.Set(MAXBROKENTIMEOUT);
            }
         }
+  Flush();
 }
@@ -27,8 +27,18 @@ private:
   char *recordingName;
   off_t fileSize;
   time_t lastDiskSpaceCheck;
+  cDynamicBuffer writeBuffer;
+  cTimeMs lastFlush;
+  cMutex statisticsMutex;
+  int writes;
+  int64_t writtenBytes;
+  uint64_t writeTime;
+  int maxWriteTime;
   bool RunningLowOnDiskSpace(void);
   bool NextFile(void);
+  bool Flush(void);
+       ///< Writes the collected TS data to the recording file in one go and then
+       ///< flushes the new index entries that refer to this data.
 protected:
   virtual void Activate(bool On);
        ///< If you override Activate() you need to call Detach() (which is a
@@ -36,12 +46,17 @@ protected:
        ///< to properly get a call to Activate(false) when your object is
        ///< destroyed.
   virtual void Receive(const uchar *Data, int Length);
+  virtual void ReceivePackets(const uchar *Data, int Length);
   virtual void Action(void);
 public:
   cRecorder(const char *FileName, const cChannel *Channel, int Priority);
        ///< Creates a new recorder for the given Channel and
        ///< the given Priority that will record into the file FileName.
   virtual ~cRecorder();
+  void GetWriteStatistics(int &Writes, int64_t &Bytes, int &AvgTime, int &MaxTime);
+       ///< Returns the number of writes to the recording's files so far, the total
+       ///< number of bytes written, and the average and maximum time (in ms) a
+       ///< single write took.
   };
 
 #endif //__RECORDER_H
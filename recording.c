@@ -17,6 +17,8 @@
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include "channels.h"
@@ -755,6 +757,7 @@ char *LimitNameLengths(char *s, int PathMax, int NameMax)
 cRecording::cRecording(cTimer *Timer, const cEvent *Event)
 {
   id = 0;
+  owner = NULL;
   resume = RESUME_NOT_INITIALIZED;
   titleBuffer = NULL;
   sortBufferName = sortBufferTime = NULL;
@@ -810,48 +813,7 @@ cRecording::cRecording(cTimer *Timer, const cEvent *Event)
 
 cRecording::cRecording(const char *FileName)
 {
-  id = 0;
-  resume = RESUME_NOT_INITIALIZED;
-  fileSizeMB = -1; // unknown
-  channel = -1;
-  instanceId = -1;
-  priority = MAXPRIORITY; // assume maximum in case there is no info file
-  lifetime = MAXLIFETIME;
-  isPesRecording = false;
-  isOnVideoDirectoryFileSystem = -1; // unknown
-  framesPerSecond = DEFAULTFRAMESPERSECOND;
-  numFrames = -1;
-  deleted = 0;
-  titleBuffer = NULL;
-  sortBufferName = sortBufferTime = NULL;
-  FileName = fileName = strdup(FileName);
-  if (*(fileName + strlen(fileName) - 1) == '/')
-     *(fileName + strlen(fileName) - 1) = 0;
-  if (strstr(FileName, cVideoDirectory::Name()) == FileName)
-     FileName += strlen(cVideoDirectory::Name()) + 1;
-  const char *p = strrchr(FileName, '/');
-
-  name = NULL;
-  info = new cRecordingInfo(fileName);
-  if (p) {
-     time_t now = time(NULL);
-     struct tm tm_r;
-     struct tm t = *localtime_r(&now, &tm_r); // this initializes the time zone in 't'
-     t.tm_isdst = -1; // makes sure mktime() will determine the correct DST setting
-     if (7 == sscanf(p + 1, DATAFORMATTS, &t.tm_year, &t.tm_mon, &t.tm_mday, &t.tm_hour, &t.tm_min, &channel, &instanceId)
-      || 7 == sscanf(p + 1, DATAFORMATPES, &t.tm_year, &t.tm_mon, &t.tm_mday, &t.tm_hour, &t.tm_min, &priority, &lifetime)) {
-        t.tm_year -= 1900;
-        t.tm_mon--;
-        t.tm_sec = 0;
-        start = mktime(&t);
-        name = MALLOC(char, p - FileName + 1);
-        strncpy(name, FileName, p - FileName);
-        name[p - FileName] = 0;
-        name = ExchangeChars(name, false);
-        isPesRecording = instanceId < 0;
-        }
-     else
-        return;
+  if (Init(FileName)) {
      GetResume();
      // read an optional info file:
      cString InfoFileName = cString::sprintf("%s%s", fileName, isPesRecording ? INFOFILESUFFIX ".vdr" : INFOFILESUFFIX);
@@ -933,6 +895,71 @@ cRecording::cRecording(const char *FileName)
      }
 }
 
+cRecording::cRecording(const char *FileName, const char *InfoData, int NumFrames, int FileSizeMB, int IsOnVideoDirectoryFileSystem)
+{
+  if (Init(FileName)) {
+     if (FILE *f = fmemopen((void *)InfoData, strlen(InfoData), "r")) {
+        if (info->Read(f) && !isPesRecording) {
+           priority = info->priority;
+           lifetime = info->lifetime;
+           framesPerSecond = info->framesPerSecond;
+           }
+        fclose(f);
+        }
+     numFrames = NumFrames;
+     fileSizeMB = FileSizeMB;
+     isOnVideoDirectoryFileSystem = IsOnVideoDirectoryFileSystem;
+     }
+}
+
+bool cRecording::Init(const char *FileName)
+{
+  id = 0;
+  owner = NULL;
+  resume = RESUME_NOT_INITIALIZED;
+  fileSizeMB = -1; // unknown
+  channel = -1;
+  instanceId = -1;
+  priority = MAXPRIORITY; // assume maximum in case there is no info file
+  lifetime = MAXLIFETIME;
+  isPesRecording = false;
+  isOnVideoDirectoryFileSystem = -1; // unknown
+  framesPerSecond = DEFAULTFRAMESPERSECOND;
+  numFrames = -1;
+  deleted = 0;
+  titleBuffer = NULL;
+  sortBufferName = sortBufferTime = NULL;
+  FileName = fileName = strdup(FileName);
+  if (*(fileName + strlen(fileName) - 1) == '/')
+     *(fileName + strlen(fileName) - 1) = 0;
+  if (strstr(FileName, cVideoDirectory::Name()) == FileName)
+     FileName += strlen(cVideoDirectory::Name()) + 1;
+  const char *p = strrchr(FileName, '/');
+
+  name = NULL;
+  info = new cRecordingInfo(fileName);
+  if (p) {
+     time_t now = time(NULL);
+     struct tm tm_r;
+     struct tm t = *localtime_r(&now, &tm_r); // this initializes the time zone in 't'
+     t.tm_isdst = -1; // makes sure mktime() will determine the correct DST setting
+     if (7 == sscanf(p + 1, DATAFORMATTS, &t.tm_year, &t.tm_mon, &t.tm_mday, &t.tm_hour, &t.tm_min, &channel, &instanceId)
+      || 7 == sscanf(p + 1, DATAFORMATPES, &t.tm_year, &t.tm_mon, &t.tm_mday, &t.tm_hour, &t.tm_min, &priority, &lifetime)) {
+        t.tm_year -= 1900;
+        t.tm_mon--;
+        t.tm_sec = 0;
+        start = mktime(&t);
+        name = MALLOC(char, p - FileName + 1);
+        strncpy(name, FileName, p - FileName);
+        name[p - FileName] = 0;
+        name = ExchangeChars(name, false);
+        isPesRecording = instanceId < 0;
+        return true;
+        }
+     }
+  return false;
+}
+
 cRecording::~cRecording()
 {
   free(titleBuffer);
@@ -1209,6 +1236,8 @@ bool cRecording::ChangePriorityLifetime(int NewPriority, int NewLifetime)
         free(fileName);
         fileName = NULL;
         cString NewFileName = FileName();
+        if (owner)
+           owner->FileNameChanged(this, OldFileName);
         if (!cVideoDirectory::RenameVideoFile(OldFileName, NewFileName))
            return false;
         info->SetFileName(NewFileName);
@@ -1243,6 +1272,8 @@ bool cRecording::ChangeName(const char *NewName)
         }
      isOnVideoDirectoryFileSystem = -1; // it might have been moved to a different file system
      ClearSortName();
+     if (owner)
+        owner->FileNameChanged(this, OldFileName);
      }
   return true;
 }
@@ -1356,31 +1387,422 @@ int cRecording::FileSizeMB(void) const
   return fileSizeMB;
 }
 
+// --- cRecordingsCache ------------------------------------------------------
+
+#define RECORDINGSCACHEVERSION  1
+#define RECORDINGSCACHEMINAGE  60 // seconds a recording's directory must not have been modified before it is cached
+#define RECORDINGSCACHEHASHSIZE 4096
+
+static unsigned int StringHash(const char *s)
+{
+  unsigned int h = 2166136261u; // FNV-1a
+  while (*s)
+        h = (h ^ uchar(*s++)) * 16777619u;
+  return h;
+}
+
+class cRecordingsCacheEntry : public cListObject {
+public:
+  char *fileName;
+  ino_t inode;
+  time_t mtime;
+  int numFrames;
+  int fileSizeMB;
+  int isOnVideoDirectoryFileSystem;
+  char *infoData;
+  bool used;
+  cRecordingsCacheEntry(const char *FileName, ino_t Inode, time_t Mtime, int NumFrames, int FileSizeMB, int IsOnVideoDirectoryFileSystem, char *InfoData);
+  virtual ~cRecordingsCacheEntry();
+  };
+
+cRecordingsCacheEntry::cRecordingsCacheEntry(const char *FileName, ino_t Inode, time_t Mtime, int NumFrames, int FileSizeMB, int IsOnVideoDirectoryFileSystem, char *InfoData)
+{
+  fileName = strdup(FileName);
+  inode = Inode;
+  mtime = Mtime;
+  numFrames = NumFrames;
+  fileSizeMB = FileSizeMB;
+  isOnVideoDirectoryFileSystem = IsOnVideoDirectoryFileSystem;
+  infoData = InfoData;
+  used = false;
+}
+
+cRecordingsCacheEntry::~cRecordingsCacheEntry()
+{
+  free(fileName);
+  free(infoData);
+}
+
+class cRecordingsCache {
+private:
+  cList<cRecordingsCacheEntry> entries;
+  cHash<cRecordingsCacheEntry> index;
+  bool enabled;
+  bool loaded;
+  bool modified;
+  int hits;
+  cRecordingsCacheEntry *GetEntry(const char *FileName);
+  void AddEntry(cRecordingsCacheEntry *Entry);
+public:
+  cRecordingsCache(void);
+  void Load(void);
+       ///< Loads the cache file (if one has been set with cRecordings::SetCacheFileName()).
+       ///< The file is only read on the first call. Any later call just prepares the
+       ///< entries that are already in memory for another scan.
+  void Save(void);
+       ///< Saves all entries that have been used since the last call to Load() to the
+       ///< cache file, if anything has changed, and removes the unused ones from memory.
+  bool Use(const char *FileName, const struct stat &St);
+       ///< Returns true if there is an up to date cache entry for the recording with
+       ///< the given FileName, which's directory has the given St, and marks it as used.
+  cRecording *NewRecording(const char *FileName, const struct stat &St);
+       ///< Returns a new cRecording, created from an up to date cache entry, or NULL
+       ///< if there is no such entry.
+  void Put(const cRecording *Recording, const struct stat &St);
+       ///< Puts the given Recording into the cache, provided all of its data is known
+       ///< and its directory hasn't been modified recently.
+  void Drop(const char *FileName);
+       ///< Removes the entry for the recording with the given FileName (if any).
+  };
+
+cRecordingsCache::cRecordingsCache(void)
+:index(RECORDINGSCACHEHASHSIZE)
+{
+  enabled = false;
+  loaded = false;
+  modified = false;
+  hits = 0;
+}
+
+cRecordingsCacheEntry *cRecordingsCache::GetEntry(const char *FileName)
+{
+  if (cList<cHashObject> *list = index.GetList(StringHash(FileName))) {
+     for (cHashObject *hob = list->First(); hob; hob = list->Next(hob)) {
+         cRecordingsCacheEntry *Entry = (cRecordingsCacheEntry *)hob->Object();
+         if (strcmp(Entry->fileName, FileName) == 0)
+            return Entry;
+         }
+     }
+  return NULL;
+}
+
+void cRecordingsCache::AddEntry(cRecordingsCacheEntry *Entry)
+{
+  entries.Add(Entry);
+  index.Add(Entry, StringHash(Entry->fileName));
+}
+
+void cRecordingsCache::Load(void)
+{
+  hits = 0;
+  if (loaded) {
+     for (cRecordingsCacheEntry *Entry = entries.First(); Entry; Entry = entries.Next(Entry))
+         Entry->used = false;
+     return;
+     }
+  loaded = true;
+  enabled = cRecordings::CacheFileName() != NULL;
+  if (!enabled)
+     return;
+  const char *FileName = cRecordings::CacheFileName();
+  FILE *f = fopen(FileName, "r");
+  if (!f) {
+     if (errno != ENOENT)
+        LOG_ERROR_STR(FileName);
+     return;
+     }
+  cReadLine ReadLine;
+  cDynamicBuffer InfoData;
+  cRecordingsCacheEntry *Entry = NULL;
+  int Version = 0;
+  int Line = 0;
+  char *s;
+  while ((s = ReadLine.Read(f)) != NULL) {
+        Line++;
+        if (Line == 1) {
+           if (sscanf(s, "V %d", &Version) != 1 || Version != RECORDINGSCACHEVERSION) {
+              isyslog("ignoring recordings cache file %s (version %d, expected %d)", FileName, Version, RECORDINGSCACHEVERSION);
+              break;
+              }
+           continue;
+           }
+        if (*s == '+' && Entry) {
+           InfoData.Append((const uchar *)s + 1, strlen(s + 1));
+           InfoData.Append('\n');
+           continue;
+           }
+        if (Entry) {
+           InfoData.Append(0);
+           Entry->infoData = strdup((const char *)InfoData.Data());
+           AddEntry(Entry);
+           Entry = NULL;
+           }
+        unsigned long long Inode;
+        long long Mtime;
+        int NumFrames, FileSizeMB, IsOnVideoDirectoryFileSystem;
+        int n = 0;
+        if (sscanf(s, "R %llu %lld %d %d %d %n", &Inode, &Mtime, &NumFrames, &FileSizeMB, &IsOnVideoDirectoryFileSystem, &n) == 5 && n > 0 && s[n]) {
+           Entry = new cRecordingsCacheEntry(s + n, ino_t(Inode), time_t(Mtime), NumFrames, FileSizeMB, IsOnVideoDirectoryFileSystem, NULL);
+           InfoData.Clear();
+           }
+        else {
+           esyslog("ERROR: invalid line %d in recordings cache file %s", Line, FileName);
+           break;
+           }
+        }
+  if (Entry) {
+     InfoData.Append(0);
+     Entry->infoData = strdup((const char *)InfoData.Data());
+     AddEntry(Entry);
+     }
+  fclose(f);
+  dsyslog("loaded %d entries from recordings cache file %s", entries.Count(), FileName);
+}
+
+void cRecordingsCache::Save(void)
+{
+  if (!enabled)
+     return;
+  int Used = 0;
+  for (cRecordingsCacheEntry *Entry = entries.First(); Entry; Entry = entries.Next(Entry)) {
+      if (Entry->used)
+         Used++;
+      }
+  if (!modified && Used == entries.Count()) {
+     dsyslog("%d recordings loaded from recordings cache", hits);
+     return;
+     }
+  const char *FileName = cRecordings::CacheFileName();
+  cSafeFile f(FileName);
+  if (f.Open()) {
+     fprintf(f, "V %d\n", RECORDINGSCACHEVERSION);
+     for (cRecordingsCacheEntry *Entry = entries.First(); Entry; Entry = entries.Next(Entry)) {
+         if (Entry->used) {
+            fprintf(f, "R %llu %lld %d %d %d %s\n", (unsigned long long)Entry->inode, (long long)Entry->mtime, Entry->numFrames, Entry->fileSizeMB, Entry->isOnVideoDirectoryFileSystem, Entry->fileName);
+            for (const char *p = Entry->infoData; *p; ) {
+                const char *e = strchrnul(p, '\n');
+                fprintf(f, "+%.*s\n", int(e - p), p);
+                p = *e ? e + 1 : e;
+                }
+            }
+         }
+     if (f.Close()) {
+        dsyslog("%d recordings loaded from recordings cache, %d entries saved to %s", hits, Used, FileName);
+        modified = false;
+        }
+     }
+  else
+     LOG_ERROR_STR(FileName);
+  // Entries of recordings that no longer exist are not kept in memory:
+  for (cRecordingsCacheEntry *Entry = entries.First(); Entry; ) {
+      cRecordingsCacheEntry *e = Entry;
+      Entry = entries.Next(Entry);
+      if (!e->used) {
+         index.Del(e, StringHash(e->fileName));
+         entries.Del(e);
+         }
+      }
+}
+
+bool cRecordingsCache::Use(const char *FileName, const struct stat &St)
+{
+  if (enabled) {
+     if (cRecordingsCacheEntry *Entry = GetEntry(FileName)) {
+        if (Entry->inode == St.st_ino && Entry->mtime == St.st_mtime) {
+           Entry->used = true;
+           return true;
+           }
+        }
+     }
+  return false;
+}
+
+cRecording *cRecordingsCache::NewRecording(const char *FileName, const struct stat &St)
+{
+  if (Use(FileName, St)) {
+     cRecordingsCacheEntry *Entry = GetEntry(FileName);
+     hits++;
+     return new cRecording(FileName, Entry->infoData, Entry->numFrames, Entry->fileSizeMB, Entry->isOnVideoDirectoryFileSystem);
+     }
+  return NULL;
+}
+
+void cRecordingsCache::Put(const cRecording *Recording, const struct stat &St)
+{
+  if (!enabled || Recording->numFrames < 0 || Recording->fileSizeMB < 0 || Recording->isOnVideoDirectoryFileSystem < 0)
+     return;
+  if (time(NULL) - St.st_mtime < RECORDINGSCACHEMINAGE)
+     return; // the recording might still be modified within the same second
+  char *InfoData = NULL;
+  size_t InfoSize = 0;
+  if (FILE *f = open_memstream(&InfoData, &InfoSize)) {
+     Recording->Info()->Write(f);
+     fclose(f);
+     }
+  if (!InfoData)
+     return;
+  cRecordingsCacheEntry *Entry = GetEntry(Recording->FileName());
+  if (Entry) {
+     free(Entry->infoData);
+     Entry->infoData = InfoData;
+     Entry->inode = St.st_ino;
+     Entry->mtime = St.st_mtime;
+     Entry->numFrames = Recording->numFrames;
+     Entry->fileSizeMB = Recording->fileSizeMB;
+     Entry->isOnVideoDirectoryFileSystem = Recording->isOnVideoDirectoryFileSystem;
+     }
+  else {
+     Entry = new cRecordingsCacheEntry(Recording->FileName(), St.st_ino, St.st_mtime, Recording->numFrames, Recording->fileSizeMB, Recording->isOnVideoDirectoryFileSystem, InfoData);
+     AddEntry(Entry);
+     }
+  Entry->used = true;
+  modified = true;
+}
+
+void cRecordingsCache::Drop(const char *FileName)
+{
+  if (cRecordingsCacheEntry *Entry = GetEntry(FileName)) {
+     index.Del(Entry, StringHash(Entry->fileName));
+     entries.Del(Entry);
+     modified = true;
+     }
+}
+
+// --- cVideoDirectoryWatcher ------------------------------------------------
+
+#define WATCHDIRMASK  (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_CLOSE_WRITE | IN_ONLYDIR)
+#define WATCHRECMASK  (IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR) // only the info file is of interest in a recording's directory
+#define WATCHHASHSIZE 1024
+
+class cVideoDirectoryWatch : public cListObject {
+public:
+  int wd;
+  cString dirName;
+  bool isRecording;
+  cVideoDirectoryWatch(int Wd, const char *DirName, bool IsRecording) { wd = Wd; dirName = DirName; isRecording = IsRecording; }
+  };
+
+class cVideoDirectoryWatcher : public cThread {
+private:
+  cMutex mutex;
+  int fd;
+  bool disabled;
+  cList<cVideoDirectoryWatch> watches;
+  cHash<cVideoDirectoryWatch> index;
+  bool RemoveWatches(const char *DirName);
+  void WatchDirectory(const char *DirName);
+  void RemoveRecordings(cRecordings *Recordings, const char *DirName);
+  void HandleEvent(const struct inotify_event *Event);
+protected:
+  virtual void Action(void);
+public:
+  cVideoDirectoryWatcher(void);
+  ~cVideoDirectoryWatcher();
+  void AddWatch(const char *DirName, bool IsRecording);
+       ///< Adds an inotify watch for the given directory. If IsRecording is true,
+       ///< the directory contains a recording, and only changes to its info file
+       ///< are reported. If the system's limit of inotify watches is exceeded, the
+       ///< watcher disables itself and VDR falls back to scanning the whole video
+       ///< directory whenever the '.update' file has been touched.
+  };
+
 // --- cVideoDirectoryScannerThread ------------------------------------------
 
+class cRecordingScanJob : public cListObject {
+public:
+  cString fileName;
+  struct stat st;
+  bool deleted;
+  bool cached;
+  cRecording *recording;
+  cRecordingScanJob(const char *FileName, const struct stat &St, bool Deleted) { fileName = FileName; st = St; deleted = Deleted; cached = false; recording = NULL; }
+  };
+
+class cVideoDirectoryScannerThread;
+
+class cRecordingScanWorker : public cThread {
+private:
+  cVideoDirectoryScannerThread *scanner;
+protected:
+  virtual void Action(void);
+public:
+  cRecordingScanWorker(cVideoDirectoryScannerThread *Scanner);
+  virtual ~cRecordingScanWorker();
+  };
+
 class cVideoDirectoryScannerThread : public cThread {
+  friend class cRecordingScanWorker;
 private:
   cRecordings *recordings;
   cRecordings *deletedRecordings;
+  cRecordingsCache cache;
+  cVideoDirectoryWatcher *watcher;
   bool initial;
+  cMutex jobMutex;
+  cCondVar jobsAvailable;
+  cList<cRecordingScanJob> pendingJobs;
+  cList<cRecordingScanJob> doneJobs;
+  bool walkDone;
+  int activeWorkers;
+  cCondVar workerDone;
   void ScanVideoDir(const char *DirName, int LinkLevel = 0, int DirLevel = 0);
+  void AddJob(cRecordingScanJob *Job);
+  void DoJobs(bool Worker);
+       ///< Creates the recordings of the pending jobs, until all jobs have been
+       ///< taken and the video directory has been completely walked through, or
+       ///< this thread has been canceled. If Worker is true, this is called by a
+       ///< cRecordingScanWorker, which doesn't access this object any more once
+       ///< DoJobs() has returned.
+  void WaitForWorkers(void);
+       ///< Waits until all workers have returned from DoJobs().
+  void MergeJobs(void);
+       ///< Adds the recordings of all done jobs to the lists of recordings and
+       ///< deleted recordings, under a single write lock.
 protected:
   virtual void Action(void);
 public:
-  cVideoDirectoryScannerThread(cRecordings *Recordings, cRecordings *DeletedRecordings);
+  cVideoDirectoryScannerThread(cRecordings *Recordings, cRecordings *DeletedRecordings, cVideoDirectoryWatcher *Watcher);
   ~cVideoDirectoryScannerThread();
   };
 
-cVideoDirectoryScannerThread::cVideoDirectoryScannerThread(cRecordings *Recordings, cRecordings *DeletedRecordings)
+// --- cRecordingScanWorker --------------------------------------------------
+
+cRecordingScanWorker::cRecordingScanWorker(cVideoDirectoryScannerThread *Scanner)
+:cThread("recording scanner")
+{
+  scanner = Scanner;
+  Start();
+}
+
+cRecordingScanWorker::~cRecordingScanWorker()
+{
+  Cancel(3);
+}
+
+void cRecordingScanWorker::Action(void)
+{
+  scanner->DoJobs(true);
+}
+
+// --- cVideoDirectoryScannerThread ------------------------------------------
+
+cVideoDirectoryScannerThread::cVideoDirectoryScannerThread(cRecordings *Recordings, cRecordings *DeletedRecordings, cVideoDirectoryWatcher *Watcher)
 :cThread("video directory scanner", true)
 {
   recordings = Recordings;
   deletedRecordings = DeletedRecordings;
+  watcher = Watcher;
   initial = true;
+  walkDone = false;
+  activeWorkers = 0;
 }
 
 cVideoDirectoryScannerThread::~cVideoDirectoryScannerThread()
 {
+  // The workers stop as soon as this thread is no longer running, and this
+  // thread must not be killed as long as any of them still accesses it:
+  Cancel(-1);
+  WaitForWorkers();
   Cancel(3);
 }
 
@@ -1388,12 +1810,129 @@ void cVideoDirectoryScannerThread::Action(void)
 {
   cStateKey StateKey;
   recordings->Lock(StateKey);
-  initial = recordings->Count() == 0; // no name checking if the list is initially empty
+  initial = recordings->Count() == 0; // the list is initially empty
   StateKey.Remove();
   deletedRecordings->Lock(StateKey, true);
   deletedRecordings->Clear();
   StateKey.Remove();
+  cache.Load();
+  // The directories are walked through by this thread, while the recordings
+  // are created by the worker threads (and this one, once the walk is done):
+  walkDone = false;
+  cVector<cRecordingScanWorker *> Workers;
+  for (int i = 1; i < constrain(Setup.RecordingScanThreads, 1, MAXRECORDINGSCANTHREADS); i++) {
+      jobMutex.Lock();
+      activeWorkers++;
+      jobMutex.Unlock();
+      Workers.Append(new cRecordingScanWorker(this));
+      }
+  watcher->AddWatch(cVideoDirectory::Name(), false);
   ScanVideoDir(cVideoDirectory::Name());
+  jobMutex.Lock();
+  walkDone = true;
+  jobsAvailable.Broadcast();
+  jobMutex.Unlock();
+  DoJobs(false);
+  WaitForWorkers();
+  for (int i = 0; i < Workers.Size(); i++)
+      delete Workers[i];
+  pendingJobs.Clear(); // in case the scan has been canceled
+  MergeJobs();
+  // Handle any vanished recordings:
+  if (!initial && Running()) {
+     recordings->Lock(StateKey, true);
+     for (cRecording *Recording = recordings->First(); Recording; ) {
+         cRecording *r = Recording;
+         Recording = recordings->Next(Recording);
+         if (access(r->FileName(), F_OK) != 0)
+            recordings->Del(r);
+         }
+     StateKey.Remove();
+     }
+  if (Running())
+     cache.Save(); // only after a complete scan, so that no entries get lost
+}
+
+void cVideoDirectoryScannerThread::AddJob(cRecordingScanJob *Job)
+{
+  cMutexLock MutexLock(&jobMutex);
+  if (Job->recording)
+     doneJobs.Add(Job);
+  else {
+     pendingJobs.Add(Job);
+     jobsAvailable.Broadcast();
+     }
+}
+
+void cVideoDirectoryScannerThread::DoJobs(bool Worker)
+{
+  cMutexLock MutexLock(&jobMutex);
+  // Note that Running() is this scanner's state, even if called by a worker:
+  while (Running()) {
+      cRecordingScanJob *Job = pendingJobs.First();
+      if (!Job) {
+         if (walkDone)
+            break;
+         jobsAvailable.Wait(jobMutex);
+         continue;
+         }
+      pendingJobs.Del(Job, false);
+      jobMutex.Unlock();
+      while (cIoThrottle::Engaged() && Running())
+            cCondWait::SleepMs(100);
+      if (Running()) {
+         cRecording *r = new cRecording(Job->fileName);
+         if (r->Name()) {
+            r->NumFrames(); // initializes the numFrames member
+            r->FileSizeMB(); // initializes the fileSizeMB member
+            r->IsOnVideoDirectoryFileSystem(); // initializes the isOnVideoDirectoryFileSystem member
+            Job->recording = r;
+            }
+         else
+            delete r;
+         }
+      jobMutex.Lock();
+      doneJobs.Add(Job);
+      }
+  if (Worker) {
+     activeWorkers--;
+     workerDone.Broadcast();
+     }
+}
+
+void cVideoDirectoryScannerThread::WaitForWorkers(void)
+{
+  cMutexLock MutexLock(&jobMutex);
+  jobsAvailable.Broadcast(); // wakes up any idle workers, in case this thread has been canceled
+  while (activeWorkers > 0)
+        workerDone.Wait(jobMutex);
+}
+
+void cVideoDirectoryScannerThread::MergeJobs(void)
+{
+  cStateKey StateKey;
+  cStateKey DeletedStateKey;
+  recordings->Lock(StateKey, true);
+  deletedRecordings->Lock(DeletedStateKey, true);
+  while (cRecordingScanJob *Job = doneJobs.First()) {
+        if (cRecording *r = Job->recording) {
+           if (!Job->cached)
+              cache.Put(r, Job->st);
+           // Even during the initial scan a recording may have been added by somebody else
+           // (for instance by AddByName() when a new recording is started) in the meantime:
+           cRecordings *Recordings = Job->deleted ? deletedRecordings : recordings;
+           if (Recordings->GetByName(r->FileName()))
+              delete r;
+           else {
+              if (Job->deleted)
+                 r->SetDeleted();
+              Recordings->Add(r);
+              }
+           }
+        doneJobs.Del(Job);
+        }
+  DeletedStateKey.Remove();
+  StateKey.Remove();
 }
 
 void cVideoDirectoryScannerThread::ScanVideoDir(const char *DirName, int LinkLevel, int DirLevel)
@@ -1418,45 +1957,256 @@ void cVideoDirectoryScannerThread::ScanVideoDir(const char *DirName, int LinkLev
                  continue;
               }
            if (S_ISDIR(st.st_mode)) {
-              cRecordings *Recordings = NULL;
-              if (endswith(buffer, RECEXT))
-                 Recordings = recordings;
-              else if (endswith(buffer, DELEXT))
-                 Recordings = deletedRecordings;
-              if (Recordings) {
-                 cStateKey StateKey;
-                 Recordings->Lock(StateKey, true);
-                 if (Recordings == deletedRecordings || initial || !Recordings->GetByName(buffer)) {
-                    cRecording *r = new cRecording(buffer);
-                    if (r->Name()) {
-                       r->NumFrames(); // initializes the numFrames member
-                       r->FileSizeMB(); // initializes the fileSizeMB member
-                       r->IsOnVideoDirectoryFileSystem(); // initializes the isOnVideoDirectoryFileSystem member
-                       if (Recordings == deletedRecordings)
-                          r->SetDeleted();
-                       Recordings->Add(r);
+              bool Deleted = endswith(buffer, DELEXT);
+              if (Deleted || endswith(buffer, RECEXT)) {
+                 if (!Deleted) {
+                    watcher->AddWatch(buffer, true);
+                    if (!initial) {
+                       cStateKey StateKey;
+                       recordings->Lock(StateKey);
+                       const cRecording *r = recordings->GetByName(buffer);
+                       // The recording in memory may have been read before its directory has
+                       // been modified, so it is only cached again by the next initial scan:
+                       if (r && !cache.Use(buffer, st))
+                          cache.Drop(buffer);
+                       StateKey.Remove();
+                       if (r)
+                          continue;
                        }
-                    else
-                       delete r;
                     }
-                 StateKey.Remove();
+                 cRecordingScanJob *Job = new cRecordingScanJob(buffer, st, Deleted);
+                 Job->recording = cache.NewRecording(buffer, st);
+                 Job->cached = Job->recording != NULL;
+                 AddJob(Job);
                  }
-              else
+              else {
+                 watcher->AddWatch(buffer, false);
                  ScanVideoDir(buffer, LinkLevel + Link, DirLevel + 1);
+                 }
               }
            }
         }
-  // Handle any vanished recordings:
-  if (!initial && DirLevel == 0) {
-     cStateKey StateKey;
-     recordings->Lock(StateKey, true);
-     for (cRecording *Recording = recordings->First(); Recording; ) {
-         cRecording *r = Recording;
-         Recording = recordings->Next(Recording);
-         if (access(r->FileName(), F_OK) != 0)
-            recordings->Del(r);
+}
+
+// --- cVideoDirectoryWatcher ------------------------------------------------
+
+cVideoDirectoryWatcher::cVideoDirectoryWatcher(void)
+:cThread("video directory watcher", true)
+,index(WATCHHASHSIZE)
+{
+  disabled = false;
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0)
+     LOG_ERROR_STR("inotify_init1");
+}
+
+cVideoDirectoryWatcher::~cVideoDirectoryWatcher()
+{
+  Cancel(3);
+  if (fd >= 0)
+     close(fd);
+}
+
+void cVideoDirectoryWatcher::AddWatch(const char *DirName, bool IsRecording)
+{
+  cMutexLock MutexLock(&mutex);
+  if (fd < 0 || disabled)
+     return;
+  int wd = inotify_add_watch(fd, DirName, IsRecording ? WATCHRECMASK : WATCHDIRMASK);
+  if (wd < 0) {
+     if (errno == ENOSPC) {
+        esyslog("ERROR: inotify watch limit exceeded (%d watches) - falling back to full video directory scans", watches.Count());
+        disabled = true; // Action() closes the file handle, which removes all watches
+        }
+     else if (errno != ENOENT)
+        LOG_ERROR_STR(DirName);
+     return;
+     }
+  if (cVideoDirectoryWatch *Watch = index.Get(wd)) { // the same directory is watched again in a later scan
+     Watch->dirName = DirName;
+     Watch->isRecording = IsRecording;
+     }
+  else {
+     Watch = new cVideoDirectoryWatch(wd, DirName, IsRecording);
+     watches.Add(Watch);
+     index.Add(Watch, wd);
+     }
+  if (!Active())
+     Start();
+}
+
+bool cVideoDirectoryWatcher::RemoveWatches(const char *DirName)
+{
+  // Removes the watches of the given directory and all of its sub directories.
+  // Returns true if there were any:
+  cMutexLock MutexLock(&mutex);
+  bool Removed = false;
+  int l = strlen(DirName);
+  for (cVideoDirectoryWatch *Watch = watches.First(); Watch; ) {
+      cVideoDirectoryWatch *w = Watch;
+      Watch = watches.Next(Watch);
+      if (strncmp(w->dirName, DirName, l) == 0 && ((*w->dirName)[l] == 0 || (*w->dirName)[l] == '/')) {
+         inotify_rm_watch(fd, w->wd);
+         index.Del(w, w->wd);
+         watches.Del(w);
+         Removed = true;
          }
-     StateKey.Remove();
+      }
+  return Removed;
+}
+
+void cVideoDirectoryWatcher::WatchDirectory(const char *DirName)
+{
+  // Watches a directory that has been created or moved into the video directory,
+  // and adds any recordings it contains:
+  if (endswith(DirName, RECEXT)) {
+     AddWatch(DirName, true);
+     LOCK_RECORDINGS_WRITE;
+     Recordings->AddByName(DirName, false);
+     Recordings->UpdateByName(DirName); // the info file may have been written before the watch was added
+     }
+  else if (endswith(DirName, DELEXT)) {
+     LOCK_RECORDINGS_WRITE; // see HandleEvent()
+     LOCK_DELETEDRECORDINGS_WRITE;
+     if (!DeletedRecordings->GetByName(DirName)) {
+        cRecording *Recording = new cRecording(DirName);
+        if (Recording->Name()) {
+           Recording->SetDeleted();
+           DeletedRecordings->Add(Recording);
+           }
+        else
+           delete Recording;
+        }
+     }
+  else {
+     AddWatch(DirName, false);
+     cReadDir d(DirName);
+     struct dirent *e;
+     while ((e = d.Next()) != NULL) {
+           cString FileName = AddDirectory(DirName, e->d_name);
+           struct stat st;
+           if (lstat(FileName, &st) == 0 && S_ISDIR(st.st_mode)) // symbolic links are only followed by a full scan
+              WatchDirectory(FileName);
+           }
+     }
+}
+
+void cVideoDirectoryWatcher::RemoveRecordings(cRecordings *Recordings, const char *DirName)
+{
+  // Removes all recordings in the given directory (or the recording DirName itself):
+  int l = strlen(DirName);
+  for (cRecording *Recording = Recordings->First(); Recording; ) {
+      cRecording *r = Recording;
+      Recording = Recordings->Next(Recording);
+      if (strncmp(r->FileName(), DirName, l) == 0 && (r->FileName()[l] == 0 || r->FileName()[l] == '/'))
+         Recordings->Del(r);
+      }
+}
+
+void cVideoDirectoryWatcher::HandleEvent(const struct inotify_event *Event)
+{
+  if (Event->mask & IN_Q_OVERFLOW) {
+     isyslog("inotify event queue overflow - rescanning video directory");
+     cRecordings::Update();
+     return;
+     }
+  cString DirName;
+  bool IsRecording;
+  {
+    cMutexLock MutexLock(&mutex);
+    cVideoDirectoryWatch *Watch = index.Get(Event->wd);
+    if (!Watch)
+       return;
+    if (Event->mask & IN_IGNORED) { // the directory has been deleted
+       index.Del(Watch, Watch->wd);
+       watches.Del(Watch);
+       return;
+       }
+    DirName = Watch->dirName;
+    IsRecording = Watch->isRecording;
+  }
+  if (!Event->len)
+     return;
+  cString FileName = AddDirectory(DirName, Event->name);
+  if (IsRecording) {
+     if (strcmp(Event->name, "info") == 0 || strcmp(Event->name, "info.vdr") == 0) { // see INFOFILESUFFIX
+        LOCK_RECORDINGS_WRITE;
+        Recordings->UpdateByName(DirName);
+        }
+     return;
+     }
+  if (!(Event->mask & IN_ISDIR)) {
+     if (strcmp(FileName, cRecordings::UpdateFileName()) == 0) {
+        // The '.update' file has been touched on this machine, so any changes that
+        // caused this have already been seen here. Only if it is touched on a
+        // different machine (over a network file system) a full scan is necessary:
+        cRecordings::UpdateSeen(LastModifiedTime(FileName));
+        return;
+        }
+     if (Event->mask & (IN_CREATE | IN_MOVED_TO)) {
+        // Symbolic links are only followed by a full scan (see WatchDirectory()):
+        struct stat st;
+        if (lstat(FileName, &st) == 0 && S_ISLNK(st.st_mode) && stat(FileName, &st) == 0 && S_ISDIR(st.st_mode)) {
+           isyslog("symbolic link %s created - rescanning video directory", *FileName);
+           cRecordings::Update();
+           }
+        return;
+        }
+     // A symbolic link to a directory has been removed if its target was being watched
+     // (the target itself still exists, so its watches need to be removed explicitly):
+     if (!((Event->mask & (IN_DELETE | IN_MOVED_FROM)) && RemoveWatches(FileName)))
+        return;
+     }
+  // Recordings are always locked before deleted recordings, and any changes this
+  // instance of VDR makes itself are done while holding the recordings lock:
+  if (Event->mask & (IN_CREATE | IN_MOVED_TO))
+     WatchDirectory(FileName);
+  else if (Event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+     if (Event->mask & IN_MOVED_FROM)
+        RemoveWatches(FileName);
+     LOCK_RECORDINGS_WRITE;
+     if (endswith(FileName, RECEXT)) {
+        if (Recordings->GetByName(FileName))
+           Recordings->DelByName(FileName, false); // moves it to the deleted recordings, if it has been renamed to *.del
+        }
+     else {
+        LOCK_DELETEDRECORDINGS_WRITE;
+        if (!endswith(FileName, DELEXT))
+           RemoveRecordings(Recordings, FileName);
+        RemoveRecordings(DeletedRecordings, FileName);
+        }
+     }
+}
+
+void cVideoDirectoryWatcher::Action(void)
+{
+  char Buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  cPoller Poller(fd);
+  while (Running()) {
+        if (disabled)
+           break;
+        if (Poller.Poll(1000)) {
+           if (cRecordings::videoDirectoryScannerThread && cRecordings::videoDirectoryScannerThread->Active()) {
+              // Any changes made during a scan are handled after it has finished:
+              cCondWait::SleepMs(100);
+              continue;
+              }
+           ssize_t n;
+           while ((n = read(fd, Buffer, sizeof(Buffer))) > 0) {
+                 for (char *p = Buffer; p < Buffer + n; ) {
+                     const struct inotify_event *Event = (const struct inotify_event *)p;
+                     HandleEvent(Event);
+                     p += sizeof(struct inotify_event) + Event->len;
+                     }
+                 }
+           }
+        }
+  if (disabled) {
+     cMutexLock MutexLock(&mutex);
+     close(fd);
+     fd = -1;
+     watches.Clear();
+     index.Clear();
      }
 }
 
@@ -1466,19 +2216,26 @@ cRecordings cRecordings::recordings;
 cRecordings cRecordings::deletedRecordings(true);
 int cRecordings::lastRecordingId = 0;
 char *cRecordings::updateFileName = NULL;
+char *cRecordings::cacheFileName = NULL;
 cVideoDirectoryScannerThread *cRecordings::videoDirectoryScannerThread = NULL;
+cVideoDirectoryWatcher *cRecordings::videoDirectoryWatcher = NULL;
 time_t cRecordings::lastUpdate = 0;
+cMutex cRecordings::lastUpdateMutex;
 
 cRecordings::cRecordings(bool Deleted)
 :cList<cRecording>(Deleted ? "4 DelRecs" : "3 Recordings")
+,idIndex(RECORDINGSHASHSIZE)
+,fileNameIndex(RECORDINGSHASHSIZE)
 {
 }
 
 cRecordings::~cRecordings()
 {
-  // The first one to be destructed deletes it:
+  // The first one to be destructed deletes it (the scanner uses the watcher):
   delete videoDirectoryScannerThread;
   videoDirectoryScannerThread = NULL;
+  delete videoDirectoryWatcher;
+  videoDirectoryWatcher = NULL;
 }
 
 const char *cRecordings::UpdateFileName(void)
@@ -1490,26 +2247,47 @@ const char *cRecordings::UpdateFileName(void)
 
 void cRecordings::TouchUpdate(void)
 {
-  bool needsUpdate = NeedsUpdate();
-  TouchFile(UpdateFileName());
-  if (!needsUpdate)
-     lastUpdate = time(NULL); // make sure we don't trigger ourselves
+  {
+    cMutexLock MutexLock(&lastUpdateMutex);
+    bool needsUpdate = NeedsUpdate();
+    TouchFile(UpdateFileName());
+    if (!needsUpdate)
+       lastUpdate = time(NULL); // make sure we don't trigger ourselves
+  }
   BroadcastSVDRPCommand("UPDR");
 }
 
+void cRecordings::UpdateSeen(time_t LastModified)
+{
+  cMutexLock MutexLock(&lastUpdateMutex);
+  if (LastModified > lastUpdate && LastModified <= time(NULL))
+     lastUpdate = LastModified;
+}
+
 bool cRecordings::NeedsUpdate(void)
 {
   time_t lastModified = LastModifiedTime(UpdateFileName());
   if (lastModified > time(NULL))
      return false; // somebody's clock isn't running correctly
+  cMutexLock MutexLock(&lastUpdateMutex);
   return lastUpdate < lastModified;
 }
 
+void cRecordings::SetCacheFileName(const char *FileName)
+{
+  free(cacheFileName);
+  cacheFileName = FileName ? strdup(FileName) : NULL;
+}
+
 void cRecordings::Update(bool Wait)
 {
-  if (!videoDirectoryScannerThread)
-     videoDirectoryScannerThread = new cVideoDirectoryScannerThread(&recordings, &deletedRecordings);
+  if (!videoDirectoryScannerThread) {
+     videoDirectoryWatcher = new cVideoDirectoryWatcher;
+     videoDirectoryScannerThread = new cVideoDirectoryScannerThread(&recordings, &deletedRecordings, videoDirectoryWatcher);
+     }
+  lastUpdateMutex.Lock();
   lastUpdate = time(NULL); // doing this first to make sure we don't miss anything
+  lastUpdateMutex.Unlock();
   videoDirectoryScannerThread->Start();
   if (Wait) {
      while (videoDirectoryScannerThread->Active())
@@ -1519,20 +2297,19 @@ void cRecordings::Update(bool Wait)
 
 const cRecording *cRecordings::GetById(int Id) const
 {
-  for (const cRecording *Recording = First(); Recording; Recording = Next(Recording)) {
-      if (Recording->Id() == Id)
-         return Recording;
-      }
-  return NULL;
+  return idIndex.Get(Id);
 }
 
 const cRecording *cRecordings::GetByName(const char *FileName) const
 {
   if (FileName) {
-     for (const cRecording *Recording = First(); Recording; Recording = Next(Recording)) {
-         if (strcmp(Recording->FileName(), FileName) == 0)
-            return Recording;
-         }
+     if (cList<cHashObject> *list = fileNameIndex.GetList(StringHash(FileName))) {
+        for (cHashObject *hob = list->First(); hob; hob = list->Next(hob)) {
+            const cRecording *Recording = (const cRecording *)hob->Object();
+            if (strcmp(Recording->FileName(), FileName) == 0)
+               return Recording;
+            }
+        }
      }
   return NULL;
 }
@@ -1540,19 +2317,52 @@ const cRecording *cRecordings::GetByName(const char *FileName) const
 void cRecordings::Add(cRecording *Recording)
 {
   Recording->SetId(++lastRecordingId);
+  Recording->owner = this;
+  idIndex.Add(Recording, Recording->Id());
+  fileNameIndex.Add(Recording, StringHash(Recording->FileName()));
   cList<cRecording>::Add(Recording);
 }
 
+void cRecordings::Del(cRecording *Recording, bool DeleteObject)
+{
+  idIndex.Del(Recording, Recording->Id());
+  fileNameIndex.Del(Recording, StringHash(Recording->FileName()));
+  Recording->owner = NULL;
+  cList<cRecording>::Del(Recording, DeleteObject);
+}
+
+void cRecordings::Clear(void)
+{
+  for (cRecording *Recording = First(); Recording; Recording = Next(Recording))
+      Recording->owner = NULL;
+  idIndex.Clear();
+  fileNameIndex.Clear();
+  cList<cRecording>::Clear();
+}
+
+void cRecordings::FileNameChanged(cRecording *Recording, const char *OldFileName)
+{
+  fileNameIndex.Del(Recording, StringHash(OldFileName));
+  fileNameIndex.Add(Recording, StringHash(Recording->FileName()));
+}
+
 void cRecordings::AddByName(const char *FileName, bool TriggerUpdate)
 {
   if (!GetByName(FileName)) {
-     Add(new cRecording(FileName));
-     if (TriggerUpdate)
-        TouchUpdate();
+     cRecording *Recording = new cRecording(FileName);
+     if (!Recording->Name()) {
+        delete Recording;
+        return;
+        }
+     Add(Recording);
      }
+  // The video directory watcher may already have added this recording, but other
+  // instances of VDR sharing the video directory still need to be told about it:
+  if (TriggerUpdate)
+     TouchUpdate();
 }
 
-void cRecordings::DelByName(const char *FileName)
+void cRecordings::DelByName(const char *FileName, bool TriggerUpdate)
 {
   cRecording *Recording = GetByName(FileName);
   cRecording *dummy = NULL;
@@ -1564,14 +2374,15 @@ void cRecordings::DelByName(const char *FileName)
   char *ext = strrchr(Recording->fileName, '.');
   if (ext) {
      strncpy(ext, DELEXT, strlen(ext));
-     if (access(Recording->FileName(), F_OK) == 0) {
+     if (access(Recording->FileName(), F_OK) == 0 && !DeletedRecordings->GetByName(Recording->FileName())) {
         Recording->SetDeleted();
         DeletedRecordings->Add(Recording);
         Recording = NULL; // to prevent it from being deleted below
         }
      }
   delete Recording;
-  TouchUpdate();
+  if (TriggerUpdate)
+     TouchUpdate();
 }
 
 void cRecordings::UpdateByName(const char *FileName)
@@ -2472,6 +3283,7 @@ struct tIndexTs {
   }
   };
 
+#define MAXPENDINGINDEX       1024 // max. number of index entries to collect before writing them to disk
 #define MAXWAITFORINDEXFILE     10 // max. time to wait for the regenerated index file (seconds)
 #define INDEXFILECHECKINTERVAL 500 // ms between checks for existence of the regenerated index file
 #define INDEXFILETESTINTERVAL   10 // ms between tests for the size of the index file in case of pausing live video
@@ -2483,6 +3295,11 @@ cIndexFile::cIndexFile(const char *FileName, bool Record, bool IsPesRecording, b
   size = 0;
   last = -1;
   index = NULL;
+  pending = NULL;
+  numPending = 0;
+  mapped = false;
+  inotifyFd = -1;
+  iFramesLast = -1;
   isPesRecording = IsPesRecording;
   indexFileGenerator = NULL;
   if (FileName) {
@@ -2515,7 +3332,38 @@ cIndexFile::cIndexFile(const char *FileName, bool Record, bool IsPesRecording, b
               esyslog("ERROR: invalid file size (%" PRId64 ") in '%s'", buf.st_size, *fileName);
               }
            last = int((buf.st_size + delta) / sizeof(tIndexTs) - 1);
-           if ((!Record || Update) && last >= 0) {
+           if (!Record && !isPesRecording && !delta && last >= 0) {
+              // A TS index file can be mapped directly into memory. The mapping is only
+              // used if we are notified of any changes to the file, because accessing
+              // pages beyond the end of a truncated file would raise SIGBUS:
+              if ((inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) >= 0) {
+                 if (inotify_add_watch(inotifyFd, fileName, IN_MODIFY) >= 0) {
+                    size = last + 1;
+                    f = open(fileName, O_RDONLY);
+                    if (f >= 0) {
+                       void *p = mmap(NULL, size * sizeof(tIndexTs), PROT_READ, MAP_SHARED, f, 0);
+                       if (p != MAP_FAILED) {
+                          index = (tIndexTs *)p;
+                          mapped = true;
+                          }
+                       else
+                          LOG_ERROR_STR(*fileName);
+                       if (!mapped || time(NULL) - buf.st_mtime >= MININDEXAGE) {
+                          close(f);
+                          f = -1;
+                          }
+                       // otherwise we don't close f here, see CatchUp()!
+                       }
+                    else
+                       LOG_ERROR_STR(*fileName);
+                    }
+                 if (!mapped) {
+                    close(inotifyFd);
+                    inotifyFd = -1;
+                    }
+                 }
+              }
+           if ((!Record || Update) && last >= 0 && !index) {
               size = last + 1;
               index = MALLOC(tIndexTs, size);
               if (index) {
@@ -2562,9 +3410,16 @@ cIndexFile::cIndexFile(const char *FileName, bool Record, bool IsPesRecording, b
 
 cIndexFile::~cIndexFile()
 {
+  Flush();
   if (f >= 0)
      close(f);
-  free(index);
+  if (inotifyFd >= 0)
+     close(inotifyFd);
+  if (mapped)
+     munmap(index, size * sizeof(tIndexTs));
+  else
+     free(index);
+  free(pending);
   delete indexFileGenerator;
 }
 
@@ -2598,6 +3453,95 @@ void cIndexFile::ConvertToPes(tIndexTs *IndexTs, int Count)
         }
 }
 
+bool cIndexFile::IndexChanged(void)
+{
+  // Reads all pending inotify events and returns true if there were any:
+  bool Changed = false;
+  char buf[1024];
+  while (read(inotifyFd, buf, sizeof(buf)) > 0)
+        Changed = true;
+  return Changed;
+}
+
+bool cIndexFile::CheckSize(void)
+{
+  // Adjusts the index to the current size of the index file (mutex must be locked).
+  // Returns false if the index could not be updated:
+  struct stat buf;
+  if ((f >= 0 ? fstat(f, &buf) : stat(fileName, &buf)) < 0) {
+     LOG_ERROR_STR(*fileName);
+     return false;
+     }
+  int newLast = int(buf.st_size / sizeof(tIndexTs) - 1);
+  if (newLast < last) {
+     if (mapped) {
+        // The pages beyond the new end of the file must never be accessed again:
+        esyslog("ERROR: index file '%s' has been truncated", *fileName);
+        last = newLast;
+        if (iFramesLast > last) {
+           while (iFrames.Size() && iFrames[iFrames.Size() - 1] > last)
+                 iFrames.Remove(iFrames.Size() - 1);
+           iFramesLast = last;
+           }
+        }
+     }
+  else if (newLast > last && f >= 0) {
+     if (mapped) {
+        void *p = mremap(index, size * sizeof(tIndexTs), (newLast + 1) * sizeof(tIndexTs), MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) {
+           LOG_ERROR_STR(*fileName);
+           return false;
+           }
+        index = (tIndexTs *)p;
+        size = newLast + 1;
+        last = newLast;
+        }
+     else {
+        int NewSize = size;
+        if (NewSize <= newLast) {
+           NewSize *= 2;
+           if (NewSize <= newLast)
+              NewSize = newLast + 1;
+           }
+        if (tIndexTs *NewBuffer = (tIndexTs *)realloc(index, NewSize * sizeof(tIndexTs))) {
+           size = NewSize;
+           index = NewBuffer;
+           int offset = (last + 1) * sizeof(tIndexTs);
+           int delta = (newLast - last) * sizeof(tIndexTs);
+           if (lseek(f, offset, SEEK_SET) == offset) {
+              if (safe_read(f, &index[last + 1], delta) != delta) {
+                 esyslog("ERROR: can't read from index");
+                 free(index);
+                 index = NULL;
+                 close(f);
+                 f = -1;
+                 return false;
+                 }
+              if (isPesRecording)
+                 ConvertFromPes(&index[last + 1], newLast - last);
+              last = newLast;
+              }
+           else
+              LOG_ERROR_STR(*fileName);
+           }
+        else {
+           esyslog("ERROR: can't realloc() index");
+           return false;
+           }
+        }
+     }
+  return true;
+}
+
+void cIndexFile::CheckMapping(void)
+{
+  // A mapped index is only accessed while the mutex is locked, so that CatchUp()
+  // can move it in memory. Any modification of the file must be taken into account
+  // before accessing it, in case it has been truncated (mutex must be locked):
+  if (mapped && IndexChanged())
+     CheckSize();
+}
+
 bool cIndexFile::CatchUp(int Index)
 {
   // returns true unless something really goes wrong, so that 'index' becomes NULL
@@ -2605,51 +3549,34 @@ bool cIndexFile::CatchUp(int Index)
      cMutexLock MutexLock(&mutex);
      // Note that CatchUp() is triggered even if Index is 'last' (and thus valid).
      // This is done to make absolutely sure we don't miss any data at the very end.
-     for (int i = 0; i <= MAXINDEXCATCHUP && (Index < 0 || Index >= last); i++) {
-         struct stat buf;
-         if (fstat(f, &buf) == 0) {
-            int newLast = int(buf.st_size / sizeof(tIndexTs) - 1);
-            if (newLast > last) {
-               int NewSize = size;
-               if (NewSize <= newLast) {
-                  NewSize *= 2;
-                  if (NewSize <= newLast)
-                     NewSize = newLast + 1;
-                  }
-               if (tIndexTs *NewBuffer = (tIndexTs *)realloc(index, NewSize * sizeof(tIndexTs))) {
-                  size = NewSize;
-                  index = NewBuffer;
-                  int offset = (last + 1) * sizeof(tIndexTs);
-                  int delta = (newLast - last) * sizeof(tIndexTs);
-                  if (lseek(f, offset, SEEK_SET) == offset) {
-                     if (safe_read(f, &index[last + 1], delta) != delta) {
-                        esyslog("ERROR: can't read from index");
-                        free(index);
-                        index = NULL;
-                        close(f);
-                        f = -1;
-                        break;
-                        }
-                     if (isPesRecording)
-                        ConvertFromPes(&index[last + 1], newLast - last);
-                     last = newLast;
-                     }
-                  else
-                     LOG_ERROR_STR(*fileName);
-                  }
-               else {
-                  esyslog("ERROR: can't realloc() index");
-                  break;
-                  }
-               }
+     if (inotifyFd >= 0) {
+        // With inotify the file size only needs to be checked if the file has actually been
+        // modified (or nothing has happened for INDEXCATCHUPWAIT ms, just to be on the safe side):
+        cTimeMs Timeout((MAXINDEXCATCHUP + 1) * INDEXCATCHUPWAIT);
+        bool Check = IndexChanged();
+        while (Index < 0 || Index >= last) {
+              if (Check && !CheckSize())
+                 break;
+              if (Index < last || Timeout.TimedOut())
+                 break;
+              // Wait until the index file is modified (or the timeout expires):
+              cPoller Poller(inotifyFd);
+              mutex.Unlock();
+              bool Ready = Poller.Poll(INDEXCATCHUPWAIT);
+              mutex.Lock();
+              Check = IndexChanged() || !Ready;
+              }
+        }
+     else {
+        for (int i = 0; i <= MAXINDEXCATCHUP && (Index < 0 || Index >= last); i++) {
+            if (!CheckSize())
+               break;
+            if (Index < last)
+               break;
+            cCondVar CondVar;
+            CondVar.TimedWait(mutex, INDEXCATCHUPWAIT);
             }
-         else
-            LOG_ERROR_STR(*fileName);
-         if (Index < last)
-            break;
-         cCondVar CondVar;
-         CondVar.TimedWait(mutex, INDEXCATCHUPWAIT);
-         }
+        }
      }
   return index != NULL;
 }
@@ -2657,23 +3584,53 @@ bool cIndexFile::CatchUp(int Index)
 bool cIndexFile::Write(bool Independent, uint16_t FileNumber, off_t FileOffset)
 {
   if (f >= 0) {
-     tIndexTs i(FileOffset, Independent, FileNumber);
+     if (!pending) {
+        pending = MALLOC(tIndexTs, MAXPENDINGINDEX);
+        if (!pending) {
+           esyslog("ERROR: can't allocate index write buffer");
+           return false;
+           }
+        }
+     pending[numPending++] = tIndexTs(FileOffset, Independent, FileNumber);
      if (isPesRecording)
-        ConvertToPes(&i, 1);
-     if (safe_write(f, &i, sizeof(i)) < 0) {
+        ConvertToPes(&pending[numPending - 1], 1);
+     last++;
+     if (numPending >= MAXPENDINGINDEX)
+        return Flush();
+     }
+  return f >= 0;
+}
+
+bool cIndexFile::Flush(void)
+{
+  if (f >= 0 && numPending) {
+     int n = numPending * sizeof(tIndexTs);
+     if (safe_write(f, pending, n) < 0) {
         LOG_ERROR_STR(*fileName);
+        // Don't leave any partially written entries in the file:
+        Discard();
+        if (ftruncate(f, (last + 1) * sizeof(tIndexTs)) < 0)
+           LOG_ERROR_STR(*fileName);
         close(f);
         f = -1;
         return false;
         }
-     last++;
+     numPending = 0;
      }
   return f >= 0;
 }
 
+void cIndexFile::Discard(void)
+{
+  last -= numPending;
+  numPending = 0;
+}
+
 bool cIndexFile::Get(int Index, uint16_t *FileNumber, off_t *FileOffset, bool *Independent, int *Length)
 {
   if (CatchUp(Index)) {
+     cMutexLock MutexLock(&mutex);
+     CheckMapping();
      if (Index >= 0 && Index <= last) {
         *FileNumber = index[Index].number;
         *FileOffset = index[Index].offset;
@@ -2697,68 +3654,84 @@ bool cIndexFile::Get(int Index, uint16_t *FileNumber, off_t *FileOffset, bool *I
   return false;
 }
 
+void cIndexFile::UpdateIFrames(void)
+{
+  // Adds any independent frames that have been added to the index since the last call:
+  int Last = min(last, size - 1);
+  while (iFramesLast < Last) {
+        if (index[++iFramesLast].independent)
+           iFrames.Append(iFramesLast);
+        }
+}
+
+int cIndexFile::FindIFrame(int Index)
+{
+  int l = 0;
+  int h = iFrames.Size();
+  while (l < h) {
+        int m = (l + h) / 2;
+        if (iFrames[m] < Index)
+           l = m + 1;
+        else
+           h = m;
+        }
+  return l;
+}
+
 int cIndexFile::GetNextIFrame(int Index, bool Forward, uint16_t *FileNumber, off_t *FileOffset, int *Length)
 {
+  int d = Forward ? 1 : -1;
   if (CatchUp()) {
-     int d = Forward ? 1 : -1;
-     for (;;) {
-         Index += d;
-         if (Index >= 0 && Index <= last) {
-            if (index[Index].independent) {
-               uint16_t fn;
-               if (!FileNumber)
-                  FileNumber = &fn;
-               off_t fo;
-               if (!FileOffset)
-                  FileOffset = &fo;
-               *FileNumber = index[Index].number;
-               *FileOffset = index[Index].offset;
-               if (Length) {
-                  if (Index < last) {
-                     uint16_t fn = index[Index + 1].number;
-                     off_t fo = index[Index + 1].offset;
-                     if (fn == *FileNumber)
-                        *Length = int(fo - *FileOffset);
-                     else
-                        *Length = -1; // this means "everything up to EOF" (the buffer's Read function will act accordingly)
-                     }
-                  else
-                     *Length = -1;
-                  }
-               return Index;
-               }
-            }
-         else
-            break;
-         }
+     cMutexLock MutexLock(&mutex);
+     CheckMapping();
+     if (Index + d < 0 || Index + d > last)
+        return -1;
+     UpdateIFrames();
+     int i = Forward ? FindIFrame(Index + 1) : FindIFrame(Index) - 1;
+     if (i >= 0 && i < iFrames.Size()) {
+        Index = iFrames[i];
+        uint16_t fn;
+        if (!FileNumber)
+           FileNumber = &fn;
+        off_t fo;
+        if (!FileOffset)
+           FileOffset = &fo;
+        *FileNumber = index[Index].number;
+        *FileOffset = index[Index].offset;
+        if (Length) {
+           if (Index < last) {
+              uint16_t fn = index[Index + 1].number;
+              off_t fo = index[Index + 1].offset;
+              if (fn == *FileNumber)
+                 *Length = int(fo - *FileOffset);
+              else
+                 *Length = -1; // this means "everything up to EOF" (the buffer's Read function will act accordingly)
+              }
+           else
+              *Length = -1;
+           }
+        return Index;
+        }
      }
   return -1;
 }
 
 int cIndexFile::GetClosestIFrame(int Index)
 {
-  if (last > 0) {
+  if (last > 0 && index) {
+     cMutexLock MutexLock(&mutex);
+     CheckMapping();
+     UpdateIFrames();
      Index = constrain(Index, 0, last);
-     if (index[Index].independent)
+     int i = FindIFrame(Index);
+     int ih = i < iFrames.Size() ? iFrames[i] : -1; // the first I-frame at or after Index
+     int il = i > 0 ? iFrames[i - 1] : -1;           // the last I-frame before Index
+     if (ih == Index)
         return Index;
-     int il = Index - 1;
-     int ih = Index + 1;
-     for (;;) {
-         if (il >= 0) {
-            if (index[il].independent)
-               return il;
-            il--;
-            }
-         else if (ih > last)
-            break;
-         if (ih <= last) {
-            if (index[ih].independent)
-               return ih;
-            ih++;
-            }
-         else if (il < 0)
-            break;
-         }
+     if (il >= 0 && (ih < 0 || Index - il <= ih - Index))
+        return il;
+     if (ih >= 0)
+        return ih;
      }
   return 0;
 }
@@ -2766,13 +3739,19 @@ int cIndexFile::GetClosestIFrame(int Index)
 int cIndexFile::Get(uint16_t FileNumber, off_t FileOffset)
 {
   if (CatchUp()) {
-     //TODO implement binary search!
-     int i;
-     for (i = 0; i <= last; i++) {
-         if (index[i].number > FileNumber || (index[i].number == FileNumber) && off_t(index[i].offset) >= FileOffset)
-            break;
-         }
-     return i;
+     cMutexLock MutexLock(&mutex);
+     CheckMapping();
+     // Binary search for the first entry at or after the given position:
+     int l = 0;
+     int h = last + 1;
+     while (l < h) {
+           int m = (l + h) / 2;
+           if (index[m].number < FileNumber || index[m].number == FileNumber && off_t(index[m].offset) < FileOffset)
+              l = m + 1;
+           else
+              h = m;
+           }
+     return l;
      }
   return -1;
 }
@@ -2786,6 +3765,7 @@ void cIndexFile::Delete(void)
 {
   if (*fileName) {
      dsyslog("deleting index file '%s'", *fileName);
+     numPending = 0;
      if (f >= 0) {
         close(f);
         f = -1;
@@ -94,8 +94,11 @@ public:
   bool Write(void) const;
   };
 
+class cRecordings;
+
 class cRecording : public cListObject {
   friend class cRecordings;
+  friend class cRecordingsCache;
 private:
   int id;
   mutable int resume;
@@ -112,6 +115,7 @@ private:
   mutable int isOnVideoDirectoryFileSystem; // -1 = unknown, 0 = no, 1 = yes
   double framesPerSecond;
   cRecordingInfo *info;
+  cRecordings *owner; // the list this recording is in (if any), which indexes it by its id and file name
   cRecording(const cRecording&); // can't copy cRecording
   cRecording &operator=(const cRecording &); // can't assign cRecording
   static char *StripEpisodeName(char *s, bool Strip);
@@ -122,6 +126,12 @@ private:
   int priority;
   int lifetime;
   time_t deleted;
+  bool Init(const char *FileName);
+       ///< Initializes this recording from the given FileName.
+       ///< Returns false if FileName is not a valid recording file name.
+  cRecording(const char *FileName, const char *InfoData, int NumFrames, int FileSizeMB, int IsOnVideoDirectoryFileSystem);
+       ///< Creates a recording from the data stored in the recordings cache, without
+       ///< accessing any of its files. InfoData is in the format of the info file.
 public:
   cRecording(cTimer *Timer, const cEvent *Event);
   cRecording(const char *FileName);
@@ -220,16 +230,33 @@ public:
   };
 
 class cVideoDirectoryScannerThread;
+class cVideoDirectoryWatcher;
+
+#define RECORDINGSHASHSIZE 4096
+#define MAXRECORDINGSCANTHREADS 16
 
 class cRecordings : public cList<cRecording> {
+  friend class cRecording;
+  friend class cVideoDirectoryWatcher;
 private:
   static cRecordings recordings;
   static cRecordings deletedRecordings;
   static int lastRecordingId;
   static char *updateFileName;
+  static char *cacheFileName;
   static time_t lastUpdate;
+  static cMutex lastUpdateMutex;
   static cVideoDirectoryScannerThread *videoDirectoryScannerThread;
+  static cVideoDirectoryWatcher *videoDirectoryWatcher;
   static const char *UpdateFileName(void);
+  static void UpdateSeen(time_t LastModified);
+       ///< Advances the time of the last update to LastModified, which is the time
+       ///< the '.update' file has been touched by this instance of VDR.
+  cHash<cRecording> idIndex;
+  cHash<cRecording> fileNameIndex;
+  void FileNameChanged(cRecording *Recording, const char *OldFileName);
+       ///< Re-indexes the given Recording after its file name has been changed from
+       ///< OldFileName.
 public:
   cRecordings(bool Deleted = false);
   virtual ~cRecordings();
@@ -256,6 +283,12 @@ public:
        ///< This function is 'const', because it doesn't actually modify the list
        ///< of recordings.
   static bool NeedsUpdate(void);
+  static void SetCacheFileName(const char *FileName);
+       ///< Sets the name of the file that caches the metadata of the recordings
+       ///< between video directory scans, so that unchanged recordings can be
+       ///< loaded without accessing their files. If no file name is set, all
+       ///< recordings are read from disk.
+  static const char *CacheFileName(void) { return cacheFileName; }
   void ResetResume(const char *ResumeFileName = NULL);
   void ClearSortNames(void);
   const cRecording *GetById(int Id) const;
@@ -263,8 +296,10 @@ public:
   const cRecording *GetByName(const char *FileName) const;
   cRecording *GetByName(const char *FileName) { return const_cast<cRecording *>(static_cast<const cRecordings *>(this)->GetByName(FileName)); }
   void Add(cRecording *Recording);
+  void Del(cRecording *Recording, bool DeleteObject = true);
+  virtual void Clear(void);
   void AddByName(const char *FileName, bool TriggerUpdate = true);
-  void DelByName(const char *FileName);
+  void DelByName(const char *FileName, bool TriggerUpdate = true);
   void UpdateByName(const char *FileName);
   int TotalFileSizeMB(void) const;
   double MBperMinute(void) const;
@@ -453,18 +488,45 @@ private:
   cString fileName;
   int size, last;
   tIndexTs *index;
+  tIndexTs *pending;
+  int numPending;
+  bool mapped;
+  int inotifyFd;
+  cVector<int> iFrames; // the indexes of all independent frames up to iFramesLast
+  int iFramesLast;
   bool isPesRecording;
   cResumeFile resumeFile;
   cIndexFileGenerator *indexFileGenerator;
   cMutex mutex;
   void ConvertFromPes(tIndexTs *IndexTs, int Count);
   void ConvertToPes(tIndexTs *IndexTs, int Count);
+  bool IndexChanged(void);
+  bool CheckSize(void);
+  void CheckMapping(void);
   bool CatchUp(int Index = -1);
+  void UpdateIFrames(void);
+  int FindIFrame(int Index);
+       ///< Returns the position in iFrames of the first independent frame with an
+       ///< index greater than or equal to Index.
 public:
   cIndexFile(const char *FileName, bool Record, bool IsPesRecording = false, bool PauseLive = false, bool Update = false);
   ~cIndexFile();
   bool Ok(void) { return index != NULL; }
   bool Write(bool Independent, uint16_t FileNumber, off_t FileOffset);
+       ///< Appends a new entry to the index file. In order to avoid a separate write()
+       ///< call for each frame, new entries are collected and only written to disk
+       ///< when Flush() is called, or when a certain number of entries has been
+       ///< collected.
+  bool Flush(void);
+       ///< Writes any entries that have been collected by Write() to disk.
+       ///< A recorder should call this after the data the entries refer to has
+       ///< been written, so that a concurrent replay never sees index entries
+       ///< before the actual data. Flush() is automatically called when the
+       ///< cIndexFile is destroyed.
+  void Discard(void);
+       ///< Discards any entries that have been collected by Write(), but not yet
+       ///< been written to disk. A recorder should call this if the data these
+       ///< entries refer to could not be written.
   bool Get(int Index, uint16_t *FileNumber, off_t *FileOffset, bool *Independent = NULL, int *Length = NULL);
   int GetNextIFrame(int Index, bool Forward, uint16_t *FileNumber = NULL, off_t *FileOffset = NULL, int *Length = NULL);
   int GetClosestIFrame(int Index);
@@ -473,6 +535,8 @@ public:
        ///< range of frame indexes.
        ///< If there is no actual index data available, 0 is returned.
   int Get(uint16_t FileNumber, off_t FileOffset);
+       ///< Returns the index of the first frame that is located at or after the
+       ///< given FileOffset in the file with the given FileNumber.
   int Last(void) { CatchUp(); return last; }
        ///< Returns the index of the last entry in this file, or -1 if the file is empty.
   int GetResume(void) { return resumeFile.Read(); }
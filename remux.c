@@ -26,6 +26,7 @@ static bool DebugFrames = false;
 #define MAX_TS_PACKETS_FOR_VIDEO_FRAME_DETECTION 6
 #define WRN_TS_PACKETS_FOR_VIDEO_FRAME_DETECTION (MAX_TS_PACKETS_FOR_VIDEO_FRAME_DETECTION / 2)
 #define WRN_TS_PACKETS_FOR_FRAME_DETECTOR (MIN_TS_PACKETS_FOR_FRAME_DETECTOR / 2)
+#define FRAME_DETECTOR_SCAN_PACKETS 8 // number of TS packet headers cFrameDetector::Analyze() scans in one go
 
 #define EMPTY_SCANNER (0xFFFFFFFF)
 
@@ -148,15 +149,128 @@ int TsSync(const uchar *Data, int Length, const char *File, const char *Function
 {
   int Skipped = 0;
   while (Length > 0 && (*Data != TS_SYNC_BYTE || Length > TS_SIZE && Data[TS_SIZE] != TS_SYNC_BYTE)) {
-        Data++;
-        Length--;
-        Skipped++;
+        // Jump right to the next candidate sync byte (memchr() is much faster than a byte-by-byte loop):
+        const uchar *p = (const uchar *)memchr(Data + 1, TS_SYNC_BYTE, Length - 1);
+        int n = p ? p - Data : Length;
+        Data += n;
+        Length -= n;
+        Skipped += n;
         }
   if (Skipped && File && Function && Line)
      esyslog("ERROR: skipped %d bytes to sync on start of TS packet at %s/%s(%d)", Skipped, File, Function, Line);
   return Skipped;
 }
 
+// TS header scanning:
+//
+// The first four bytes of a TS packet, read as a little endian 32 bit value h,
+// are turned into a tTsHeader (again read as a little endian 32 bit value) by
+//
+//   pid:   (h & 0x00001F00) | ((h >> 16) & 0x000000FF)
+//   flags: TSH_SYNC if (h & 0xFF) == TS_SYNC_BYTE
+//          | ((h << 2) & 0x00020000)   TS_ERROR         -> TSH_ERROR
+//          | ((h << 4) & 0x00040000)   TS_PAYLOAD_START -> TSH_PAYLOAD_START
+//          | ((h >> 8) & 0x00F00000)   scrambling, adaptation field and payload bits
+//
+// which only takes a few shifts and masks that can be done for 4 (SSE2) or 8 (AVX2)
+// packets at once.
+
+#if defined(__x86_64__) || defined(__i386__) && defined(__SSE2__)
+#define TS_SCAN_X86
+#include <immintrin.h>
+#endif
+
+static inline void TsScanHeader(const uchar *p, tTsHeader *Header)
+{
+  Header->pid = TsPid(p);
+  Header->flags = (p[0] == TS_SYNC_BYTE ? TSH_SYNC : 0) | ((p[1] & TS_ERROR) ? TSH_ERROR : 0) | ((p[1] & TS_PAYLOAD_START) ? TSH_PAYLOAD_START : 0) | (p[3] & (TSH_SCRAMBLED | TSH_ADAPT_FIELD | TSH_PAYLOAD));
+  Header->reserved = 0;
+}
+
+#ifdef TS_SCAN_X86
+
+static inline __m128i TsLoadHeader(const uchar *p)
+{
+  int h;
+  memcpy(&h, p, sizeof(h));
+  return _mm_cvtsi32_si128(h);
+}
+
+static int TsScanHeadersSse2(const uchar *Data, tTsHeader *Headers, int Packets)
+{
+  // Returns the number of packets that have been scanned, which is a multiple of 4
+  // and only includes packets that are in sync:
+  const __m128i SyncByte = _mm_set1_epi32(TS_SYNC_BYTE);
+  int i = 0;
+  for (; i + 4 <= Packets; i += 4) {
+      const uchar *p = Data + i * TS_SIZE;
+      __m128i h01 = _mm_unpacklo_epi32(TsLoadHeader(p), TsLoadHeader(p + TS_SIZE));
+      __m128i h23 = _mm_unpacklo_epi32(TsLoadHeader(p + 2 * TS_SIZE), TsLoadHeader(p + 3 * TS_SIZE));
+      __m128i h = _mm_unpacklo_epi64(h01, h23);
+      __m128i Sync = _mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(0xFF)), SyncByte);
+      if (_mm_movemask_epi8(Sync) != 0xFFFF)
+         break;
+      __m128i r = _mm_or_si128(_mm_and_si128(h, _mm_set1_epi32(0x00001F00)), _mm_and_si128(_mm_srli_epi32(h, 16), _mm_set1_epi32(0x000000FF)));
+      r = _mm_or_si128(r, _mm_and_si128(_mm_slli_epi32(h, 2), _mm_set1_epi32(0x00020000)));
+      r = _mm_or_si128(r, _mm_and_si128(_mm_slli_epi32(h, 4), _mm_set1_epi32(0x00040000)));
+      r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi32(h, 8), _mm_set1_epi32(0x00F00000)));
+      r = _mm_or_si128(r, _mm_set1_epi32(TSH_SYNC << 16));
+      _mm_storeu_si128((__m128i *)&Headers[i], r);
+      }
+  return i;
+}
+
+__attribute__((target("avx2")))
+static int TsScanHeadersAvx2(const uchar *Data, tTsHeader *Headers, int Packets)
+{
+  // Same as TsScanHeadersSse2(), but for 8 packets at once:
+  const __m256i Offsets = _mm256_setr_epi32(0, TS_SIZE, 2 * TS_SIZE, 3 * TS_SIZE, 4 * TS_SIZE, 5 * TS_SIZE, 6 * TS_SIZE, 7 * TS_SIZE);
+  const __m256i SyncByte = _mm256_set1_epi32(TS_SYNC_BYTE);
+  int i = 0;
+  for (; i + 8 <= Packets; i += 8) {
+      __m256i h = _mm256_i32gather_epi32((const int *)(Data + i * TS_SIZE), Offsets, 1);
+      __m256i Sync = _mm256_cmpeq_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0xFF)), SyncByte);
+      if (uint32_t(_mm256_movemask_epi8(Sync)) != 0xFFFFFFFF)
+         break;
+      __m256i r = _mm256_or_si256(_mm256_and_si256(h, _mm256_set1_epi32(0x00001F00)), _mm256_and_si256(_mm256_srli_epi32(h, 16), _mm256_set1_epi32(0x000000FF)));
+      r = _mm256_or_si256(r, _mm256_and_si256(_mm256_slli_epi32(h, 2), _mm256_set1_epi32(0x00020000)));
+      r = _mm256_or_si256(r, _mm256_and_si256(_mm256_slli_epi32(h, 4), _mm256_set1_epi32(0x00040000)));
+      r = _mm256_or_si256(r, _mm256_and_si256(_mm256_srli_epi32(h, 8), _mm256_set1_epi32(0x00F00000)));
+      r = _mm256_or_si256(r, _mm256_set1_epi32(TSH_SYNC << 16));
+      _mm256_storeu_si256((__m256i *)&Headers[i], r);
+      }
+  return i;
+}
+
+static bool TsScanHasAvx2(void)
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+static bool TsScanAvx2 = TsScanHasAvx2();
+
+#endif
+
+int TsScanHeaders(const uchar *Data, int Length, tTsHeader *Headers, int MaxPackets)
+{
+  int Packets = min(Length / TS_SIZE, MaxPackets);
+  int i = 0;
+#ifdef TS_SCAN_X86
+  // The vectorized code relies on tTsHeader having the layout of a little endian 32 bit value:
+  if (sizeof(tTsHeader) == sizeof(uint32_t))
+     i = TsScanAvx2 ? TsScanHeadersAvx2(Data, Headers, Packets) : TsScanHeadersSse2(Data, Headers, Packets);
+#endif
+  // Any remaining packets (and the block with the first packet that is out of sync):
+  for (; i < Packets; i++) {
+      const uchar *p = Data + i * TS_SIZE;
+      if (*p != TS_SYNC_BYTE)
+         break;
+      TsScanHeader(p, &Headers[i]);
+      }
+  return i;
+}
+
 int64_t TsGetPts(const uchar *p, int l)
 {
   // Find the first packet with a PTS and use it:
@@ -1655,22 +1769,31 @@ int cFrameDetector::Analyze(const uchar *Data, int Length)
      return 0;
   int Processed = 0;
   newFrame = independentFrame = false;
+  // Most calls return at the next packet of our PID, so only a few headers are scanned at a time:
+  tTsHeader Headers[FRAME_DETECTOR_SCAN_PACKETS];
+  int NumHeaders = 0;
+  int Header = 0;
   while (Length >= MIN_TS_PACKETS_FOR_FRAME_DETECTOR * TS_SIZE) { // makes sure we are looking at enough data, in case the frame type is not stored in the first TS packet
-        // Sync on TS packet borders:
-        if (int Skipped = TS_SYNC(Data, Length))
-           return Processed + Skipped;
+        if (Header >= NumHeaders) {
+           // Sync on TS packet borders:
+           if (int Skipped = TS_SYNC(Data, Length))
+              return Processed + Skipped;
+           NumHeaders = TsScanHeaders(Data, Length, Headers, FRAME_DETECTOR_SCAN_PACKETS);
+           Header = 0;
+           }
+        const tTsHeader &h = Headers[Header];
         // Handle one TS packet:
         int Handled = TS_SIZE;
-        if (TsHasPayload(Data) && !TsIsScrambled(Data)) {
-           int Pid = TsPid(Data);
+        if ((h.flags & TSH_PAYLOAD) && !(h.flags & TSH_SCRAMBLED)) {
+           int Pid = h.pid;
            if (Pid == pid) {
               if (Processed)
                  return Processed;
-              if (TsPayloadStart(Data))
+              if (h.flags & TSH_PAYLOAD_START)
                  scanning = true;
               if (scanning) {
                  // Detect the beginning of a new frame:
-                 if (TsPayloadStart(Data)) {
+                 if (h.flags & TSH_PAYLOAD_START) {
                     if (!framesPerPayloadUnit)
                        framesPerPayloadUnit = framesInPayloadUnit;
                     }
@@ -1692,7 +1815,7 @@ int cFrameDetector::Analyze(const uchar *Data, int Length)
                     Handled = n;
                     }
                  }
-              if (TsPayloadStart(Data)) {
+              if (h.flags & TSH_PAYLOAD_START) {
                  // Determine the frame rate from the PTS values in the PES headers:
                  if (framesPerSecond <= 0.0) {
                     // frame rate unknown, so collect a sequence of PTS values:
@@ -1759,6 +1882,8 @@ int cFrameDetector::Analyze(const uchar *Data, int Length)
         Processed += Handled;
         if (newFrame)
            break;
+        // The parser may have consumed several packets (the headers are scanned anew if it didn't end on a packet border):
+        Header = Handled % TS_SIZE ? NumHeaders : Header + Handled / TS_SIZE;
         }
   return Processed;
 }
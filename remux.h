@@ -149,6 +149,34 @@ void TsSetPcr(uchar *p, int64_t Pcr);
 #define TS_SYNC(Data, Length) (*Data == TS_SYNC_BYTE ? 0 : TsSync(Data, Length, __FILE__, __FUNCTION__, __LINE__))
 int TsSync(const uchar *Data, int Length, const char *File = NULL, const char *Function = NULL, int Line = 0);
 
+// Scanning the headers of a whole block of TS packets in one go (using SIMD
+// instructions, where available) is much faster than evaluating TsPid() etc.
+// separately for each packet. The result is a compact side array with one
+// tTsHeader per packet:
+
+#define TSH_SYNC          0x01 // the packet starts with TS_SYNC_BYTE
+#define TSH_ERROR         0x02 // the packet has TS_ERROR set
+#define TSH_PAYLOAD_START 0x04 // the packet has TS_PAYLOAD_START set
+#define TSH_PAYLOAD       TS_PAYLOAD_EXISTS
+#define TSH_ADAPT_FIELD   TS_ADAPT_FIELD_EXISTS
+#define TSH_SCRAMBLED     TS_SCRAMBLING_CONTROL // any of these bits set means the packet is scrambled
+
+#define TS_SCAN_PACKETS   32 // the default number of TS packets to scan in one go
+
+struct tTsHeader {
+  uint16_t pid;
+  uchar flags;
+  uchar reserved;
+  };
+
+int TsScanHeaders(const uchar *Data, int Length, tTsHeader *Headers, int MaxPackets);
+     ///< Scans the headers of the TS packets in Data (of Length bytes), and stores the
+     ///< PID and flags of each packet in Headers, which must have room for MaxPackets
+     ///< entries. Scanning stops at the first packet that doesn't start with a
+     ///< TS_SYNC_BYTE, after MaxPackets packets, or if there is no complete TS packet
+     ///< left. Returns the number of packets that have been scanned (all of which have
+     ///< TSH_SYNC set).
+
 // The following functions all take a pointer to a sequence of complete TS packets.
 
 int64_t TsGetPts(const uchar *p, int l);
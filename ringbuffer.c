@@ -12,6 +12,7 @@
 
 #include "ringbuffer.h"
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include "tools.h"
 
@@ -27,6 +28,7 @@ cRingBuffer::cRingBuffer(int Size, bool Statistics)
 {
   size = Size;
   statistics = Statistics;
+  putWaiting = getWaiting = false;
   getThreadTid = 0;
   maxFill = 0;
   lastPercent = 0;
@@ -62,28 +64,47 @@ void cRingBuffer::UpdatePercentage(int Fill)
      }
 }
 
+// The 'waiting' flags make sure the cCondWait (and thus its mutex) is only used if
+// the other side is actually going to sleep. Setting the flag and then checking the
+// condition again (and vice versa on the other side) requires sequential consistency,
+// otherwise a wakeup could get lost and the waiting side would sleep until its timeout.
+
 void cRingBuffer::WaitForPut(void)
 {
-  if (putTimeout)
-     readyForPut.Wait(putTimeout);
+  if (putTimeout) {
+     __atomic_store_n(&putWaiting, true, __ATOMIC_SEQ_CST);
+     if (Free() <= Size() / 10)
+        readyForPut.Wait(putTimeout);
+     __atomic_store_n(&putWaiting, false, __ATOMIC_RELAXED);
+     }
 }
 
 void cRingBuffer::WaitForGet(void)
 {
-  if (getTimeout)
-     readyForGet.Wait(getTimeout);
+  if (getTimeout) {
+     __atomic_store_n(&getWaiting, true, __ATOMIC_SEQ_CST);
+     if (Available() <= Size() / 10)
+        readyForGet.Wait(getTimeout);
+     __atomic_store_n(&getWaiting, false, __ATOMIC_RELAXED);
+     }
 }
 
 void cRingBuffer::EnablePut(void)
 {
-  if (putTimeout && Free() > Size() / 10)
-     readyForPut.Signal();
+  if (putTimeout) {
+     __atomic_thread_fence(__ATOMIC_SEQ_CST);
+     if (__atomic_load_n(&putWaiting, __ATOMIC_RELAXED) && Free() > Size() / 10)
+        readyForPut.Signal();
+     }
 }
 
 void cRingBuffer::EnableGet(void)
 {
-  if (getTimeout && Available() > Size() / 10)
-     readyForGet.Signal();
+  if (getTimeout) {
+     __atomic_thread_fence(__ATOMIC_SEQ_CST);
+     if (__atomic_load_n(&getWaiting, __ATOMIC_RELAXED) && Available() > Size() / 10)
+        readyForGet.Signal();
+     }
 }
 
 void cRingBuffer::SetTimeouts(int PutTimeout, int GetTimeout)
@@ -167,16 +188,65 @@ void cRingBufferLinear::PrintDebugRBL(void)
   }
 #endif
 
-cRingBufferLinear::cRingBufferLinear(int Size, int Margin, bool Statistics, const char *Description)
-:cRingBuffer(Size, Statistics)
+// In a mirrored buffer the part behind 'margin' (where the data actually lives)
+// consists of whole pages, and these pages are mapped a second time directly
+// after the end of the buffer. So data that wraps around at the end of the buffer
+// is also available in one consecutive block right after the end.
+
+int cRingBufferLinear::MirroredSize(int Size, int Margin)
+{
+  int PageSize = sysconf(_SC_PAGESIZE);
+  return Margin + (max(Size - Margin, 1) + PageSize - 1) / PageSize * PageSize;
+}
+
+uchar *cRingBufferLinear::MirroredAlloc(int Size)
+{
+  uchar *p = NULL;
+  int fd = memfd_create("ringbuffer", MFD_CLOEXEC);
+  if (fd >= 0) {
+     if (ftruncate(fd, Size) == 0) {
+        void *a = mmap(NULL, 2 * Size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (a != MAP_FAILED) {
+           if (mmap(a, Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED && mmap((uchar *)a + Size, Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED)
+              p = (uchar *)a;
+           else {
+              LOG_ERROR;
+              munmap(a, 2 * Size);
+              }
+           }
+        else
+           LOG_ERROR;
+        }
+     else
+        LOG_ERROR;
+     close(fd);
+     }
+  else
+     LOG_ERROR;
+  return p;
+}
+
+cRingBufferLinear::cRingBufferLinear(int Size, int Margin, bool Statistics, const char *Description, bool Mirrored)
+:cRingBuffer(Mirrored ? MirroredSize(Size, Margin) : Size, Statistics)
 {
   description = Description ? strdup(Description) : NULL;
   tail = head = margin = Margin;
   gotten = 0;
   buffer = NULL;
+  mirrored = false;
+  Size = cRingBuffer::Size();
   if (Size > 1) { // 'Size - 1' must not be 0!
      if (Margin <= Size / 2) {
-        buffer = MALLOC(uchar, Size);
+        if (Mirrored) {
+           if (uchar *p = MirroredAlloc(Size - Margin)) {
+              buffer = p - Margin; // the margin itself is never accessed in a mirrored buffer
+              mirrored = true;
+              }
+           else
+              esyslog("ERROR: can't set up mirrored ring buffer (size=%d), using ordinary buffer", Size);
+           }
+        if (!buffer)
+           buffer = MALLOC(uchar, Size);
         if (!buffer)
            esyslog("ERROR: can't allocate ring buffer (size=%d)", Size);
         Clear();
@@ -199,7 +269,10 @@ cRingBufferLinear::~cRingBufferLinear()
 #ifdef DEBUGRINGBUFFERS
   DelDebugRBL(this);
 #endif
-  free(buffer);
+  if (mirrored)
+     munmap(buffer + margin, 2 * (Size() - margin));
+  else
+     free(buffer);
   free(description);
 }
 
@@ -210,14 +283,14 @@ int cRingBufferLinear::DataReady(const uchar *Data, int Count)
 
 int cRingBufferLinear::Available(void)
 {
-  int diff = head - tail;
+  int diff = __atomic_load_n(&head, __ATOMIC_ACQUIRE) - __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
   return (diff >= 0) ? diff : Size() + diff - margin;
 }
 
 void cRingBufferLinear::Clear(void)
 {
-  int Head = head;
-  tail = Head;
+  int Head = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+  __atomic_store_n(&tail, Head, __ATOMIC_RELEASE);
 #ifdef DEBUGRINGBUFFERS
   lastHead = Head;
   lastTail = tail;
@@ -229,7 +302,7 @@ void cRingBufferLinear::Clear(void)
 
 int cRingBufferLinear::Read(int FileHandle, int Max)
 {
-  int Tail = tail;
+  int Tail = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
   int diff = Tail - head;
   int free = (diff > 0) ? diff - 1 : Size() - head;
   if (Tail <= margin)
@@ -244,7 +317,7 @@ int cRingBufferLinear::Read(int FileHandle, int Max)
         int Head = head + Count;
         if (Head >= Size())
            Head = margin;
-        head = Head;
+        __atomic_store_n(&head, Head, __ATOMIC_RELEASE);
         if (statistics) {
            int fill = head - Tail;
            if (fill < 0)
@@ -267,7 +340,7 @@ int cRingBufferLinear::Read(int FileHandle, int Max)
 
 int cRingBufferLinear::Read(cUnbufferedFile *File, int Max)
 {
-  int Tail = tail;
+  int Tail = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
   int diff = Tail - head;
   int free = (diff > 0) ? diff - 1 : Size() - head;
   if (Tail <= margin)
@@ -282,7 +355,7 @@ int cRingBufferLinear::Read(cUnbufferedFile *File, int Max)
         int Head = head + Count;
         if (Head >= Size())
            Head = margin;
-        head = Head;
+        __atomic_store_n(&head, Head, __ATOMIC_RELEASE);
         if (statistics) {
            int fill = head - Tail;
            if (fill < 0)
@@ -306,7 +379,7 @@ int cRingBufferLinear::Read(cUnbufferedFile *File, int Max)
 int cRingBufferLinear::Put(const uchar *Data, int Count)
 {
   if (Count > 0) {
-     int Tail = tail;
+     int Tail = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
      int rest = Size() - head;
      int diff = Tail - head;
      int free = ((Tail < margin) ? rest : (diff > 0) ? diff : Size() + diff - margin) - 1;
@@ -323,11 +396,11 @@ int cRingBufferLinear::Put(const uchar *Data, int Count)
            memcpy(buffer + head, Data, rest);
            if (Count - rest)
               memcpy(buffer + margin, Data + rest, Count - rest);
-           head = margin + Count - rest;
+           __atomic_store_n(&head, margin + Count - rest, __ATOMIC_RELEASE);
            }
         else {
            memcpy(buffer + head, Data, Count);
-           head += Count;
+           __atomic_store_n(&head, head + Count, __ATOMIC_RELEASE);
            }
         }
      else
@@ -345,14 +418,16 @@ int cRingBufferLinear::Put(const uchar *Data, int Count)
 
 uchar *cRingBufferLinear::Get(int &Count)
 {
-  int Head = head;
+  int Head = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
   if (getThreadTid <= 0)
      getThreadTid = cThread::ThreadId();
   int rest = Size() - tail;
-  if (rest < margin && Head < tail) {
+  if (mirrored)
+     rest = Size() - margin; // data beyond the end of the buffer is continued in the mirrored pages
+  else if (rest < margin && Head < tail) {
      int t = margin - rest;
      memcpy(buffer + t, buffer + tail, rest);
-     tail = t;
+     __atomic_store_n(&tail, t, __ATOMIC_RELEASE);
      rest = Head - tail;
      }
   int diff = Head - tail;
@@ -379,8 +454,8 @@ void cRingBufferLinear::Del(int Count)
      Tail += Count;
      gotten -= Count;
      if (Tail >= Size())
-        Tail = margin;
-     tail = Tail;
+        Tail -= Size() - margin; // in a mirrored buffer the deleted data may reach beyond the end
+     __atomic_store_n(&tail, Tail, __ATOMIC_RELEASE);
      EnablePut();
      }
 #ifdef DEBUGRINGBUFFERS
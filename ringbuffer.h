@@ -16,6 +16,7 @@
 class cRingBuffer {
 private:
   cCondWait readyForPut, readyForGet;
+  bool putWaiting, getWaiting; // only signal a cCondWait if the other side actually waits on it
   int putTimeout;
   int getTimeout;
   int size;
@@ -58,10 +59,13 @@ public:
   static void PrintDebugRBL(void);
 #endif
 private:
-  int margin, head, tail;
+  int margin, head, tail; // 'head' is only written by the producer, 'tail' only by the consumer
   int gotten;
   uchar *buffer;
+  bool mirrored;
   char *description;
+  static int MirroredSize(int Size, int Margin);
+  static uchar *MirroredAlloc(int Size);
 protected:
   virtual int DataReady(const uchar *Data, int Count);
     ///< By default a ring buffer has data ready as soon as there are at least
@@ -70,11 +74,19 @@ protected:
     ///< The return value is either 0 if there is not yet enough data available,
     ///< or the number of bytes from the beginning of Data that are "ready".
 public:
-  cRingBufferLinear(int Size, int Margin = 0, bool Statistics = false, const char *Description = NULL);
+  cRingBufferLinear(int Size, int Margin = 0, bool Statistics = false, const char *Description = NULL, bool Mirrored = false);
     ///< Creates a linear ring buffer.
     ///< The buffer will be able to hold at most Size-Margin-1 bytes of data, and will
     ///< be guaranteed to return at least Margin bytes in one consecutive block.
     ///< The optional Description is used for debugging only.
+    ///< If Mirrored is true, the memory of the buffer is mapped twice in a row, so
+    ///< that Get() always returns all available data in one consecutive block, without
+    ///< having to copy any data at the wrap around point. In this case Size is rounded
+    ///< up to fit the system's page size. If the mirrored mapping can't be set up, an
+    ///< ordinary buffer is used.
+    ///< A linear ring buffer is a lock free single producer/single consumer queue:
+    ///< Read() and Put() may be called from one thread, while Get() and Del() are
+    ///< called from an other one, without any additional locking.
   virtual ~cRingBufferLinear();
   virtual int Available(void);
   virtual int Free(void) { return Size() - Available() - 1 - margin; }
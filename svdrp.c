@@ -940,6 +940,11 @@ const char *GetHelpPage(const char *Cmd, const char **p)
 
 static cString grabImageDir;
 
+#define SVDRPREADSIZE     BUFSIZ        // max. number of bytes read from a client in one go
+#define SVDRPMAXOUTPUT    KILOBYTE(256) // no further commands are executed while more output is pending
+#define SVDRPMAXCOMMANDS  100           // no more input is read while this many commands are waiting to be executed
+#define SVDRPMAXWORKERS   4             // max. number of threads executing SVDRP commands
+
 class cSVDRPServer {
 private:
   int socket;
@@ -950,8 +955,21 @@ private:
   int length;
   char *cmdLine;
   time_t lastActivity;
+  cMutex mutex; // protects the following members, which are shared with the worker that executes this connection's commands
+  cCondVar outputSent;
+  cDynamicBuffer output;
+  int outputOffset; // the number of bytes in 'output' that have already been sent
+  cStringList commands; // commands that have been received, but not yet executed
+  bool busy; // a worker is executing one of this connection's commands
+  bool closing; // the connection will be closed as soon as all output has been sent
   void Close(bool SendReply = false, bool Timeout = false);
+  void Disconnect(void);
   bool Send(const char *s, int length = -1);
+  void WaitForOutput(void);
+  bool Flush(void);
+  void Receive(const uchar *Data, int Length);
+  static ssize_t WriteOutput(void *Cookie, const char *Buffer, size_t Size);
+  FILE *OpenOutput(void);
   void Reply(int Code, const char *fmt, ...) __attribute__ ((format (printf, 3, 4)));
   void PrintHelpTopics(const char **hp);
   void CmdCHAN(const char *Option);
@@ -991,10 +1009,28 @@ public:
   cSVDRPServer(int Socket, const char *Connection);
   ~cSVDRPServer();
   bool HasConnection(void) { return file.IsOpen(); }
+  void AddToPoller(cPoller &Poller);
+       ///< Adds this connection to the given Poller, if it wants to read or write data.
+  bool StartCommand(void);
+       ///< Returns true if there is a command that can be handed to a worker, which
+       ///< then has to call ExecuteCommand().
+  void ExecuteCommand(void);
+  void Abort(void);
+       ///< Makes a worker that is waiting for output to be sent on this connection return.
   bool Process(void);
   };
 
-static cPoller SVDRPServerPoller;
+static int SVDRPServerWakeupPipe[2] = { -1, -1 }; // makes the server handler return from Poll() when a command has been executed
+static cMutex SVDRPExecuteMutex; // serializes all commands that may modify data
+
+static void WakeupSVDRPServerHandler(void)
+{
+  if (SVDRPServerWakeupPipe[1] >= 0) {
+     char c = 0;
+     if (write(SVDRPServerWakeupPipe[1], &c, 1) < 0 && errno != EAGAIN)
+        LOG_ERROR;
+     }
+}
 
 cSVDRPServer::cSVDRPServer(int Socket, const char *Connection)
 {
@@ -1005,10 +1041,12 @@ cSVDRPServer::cSVDRPServer(int Socket, const char *Connection)
   length = BUFSIZ;
   cmdLine = MALLOC(char, length);
   lastActivity = time(NULL);
+  outputOffset = 0;
+  busy = false;
+  closing = false;
   if (file.Open(socket)) {
      time_t now = time(NULL);
      Reply(220, "%s SVDRP VideoDiskRecorder %s; %s; %s", Setup.SVDRPHostName, VDRVERSION, *TimeToString(now), cCharSetConv::SystemCharacterTable() ? cCharSetConv::SystemCharacterTable() : "UTF-8");
-     SVDRPServerPoller.Add(file, false);
      }
   dsyslog("SVDRP < %s server created", *connection);
 }
@@ -1016,36 +1054,105 @@ cSVDRPServer::cSVDRPServer(int Socket, const char *Connection)
 cSVDRPServer::~cSVDRPServer()
 {
   Close(true);
+  cMutexLock MutexLock(&mutex);
+  Flush();
+  Disconnect();
+  delete PUTEhandler;
   free(cmdLine);
   dsyslog("SVDRP < %s server destroyed", *connection);
 }
 
 void cSVDRPServer::Close(bool SendReply, bool Timeout)
 {
-  if (file.IsOpen()) {
+  // The connection is actually closed by Process(), after all output has been sent:
+  cMutexLock MutexLock(&mutex);
+  if (file.IsOpen() && !closing) {
      if (SendReply) {
         Reply(221, "%s closing connection%s", Setup.SVDRPHostName, Timeout ? " (timeout)" : "");
         }
+     closing = true;
+     }
+}
+
+void cSVDRPServer::Disconnect(void)
+{
+  if (file.IsOpen()) {
      isyslog("SVDRP < %s connection closed", *connection);
-     SVDRPServerPoller.Del(file, false);
      file.Close();
-     DELETENULL(PUTEhandler);
+     outputSent.Broadcast();
      }
   close(socket);
 }
 
+void cSVDRPServer::Abort(void)
+{
+  cMutexLock MutexLock(&mutex);
+  Disconnect();
+}
+
 bool cSVDRPServer::Send(const char *s, int length)
 {
   if (length < 0)
      length = strlen(s);
-  if (safe_write(file, s, length) < 0) {
-     LOG_ERROR;
-     Close();
+  // This never waits for the client, because commands may call it while holding locks:
+  cMutexLock MutexLock(&mutex);
+  if (!file.IsOpen())
      return false;
+  output.Append((const uchar *)s, length);
+  return true;
+}
+
+void cSVDRPServer::WaitForOutput(void)
+{
+  // Waits until the client has taken enough of the output. This must not be called
+  // while holding any locks!
+  cMutexLock MutexLock(&mutex);
+  while (file.IsOpen() && output.Length() - outputOffset > SVDRPMAXOUTPUT) {
+        WakeupSVDRPServerHandler();
+        outputSent.TimedWait(mutex, 1000);
+        }
+}
+
+bool cSVDRPServer::Flush(void)
+{
+  // Sends as much of the pending output as the socket takes without blocking:
+  while (file.IsOpen() && outputOffset < output.Length()) {
+        int w = send(file, output.Data() + outputOffset, output.Length() - outputOffset, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (w > 0) {
+           outputOffset += w;
+           lastActivity = time(NULL);
+           }
+        else if (w < 0 && errno == EINTR)
+           continue;
+        else if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+           break;
+        else {
+           LOG_ERROR;
+           return false;
+           }
+        }
+  int Rest = output.Length() - outputOffset;
+  if (Rest <= outputOffset) { // the rest can be moved to the front without overlapping
+     output.Clear();
+     output.Append(output.Data() + outputOffset, Rest);
+     outputOffset = 0;
      }
+  outputSent.Broadcast();
   return true;
 }
 
+ssize_t cSVDRPServer::WriteOutput(void *Cookie, const char *Buffer, size_t Size)
+{
+  return ((cSVDRPServer *)Cookie)->Send(Buffer, Size) ? ssize_t(Size) : -1;
+}
+
+FILE *cSVDRPServer::OpenOutput(void)
+{
+  // Returns a FILE that writes into the output buffer of this connection:
+  cookie_io_functions_t Functions = { NULL, WriteOutput, NULL, NULL };
+  return fopencookie(this, "w", Functions);
+}
+
 void cSVDRPServer::Reply(int Code, const char *fmt, ...)
 {
   if (file.IsOpen()) {
@@ -1622,12 +1729,14 @@ void cSVDRPServer::CmdLSTC(const char *Option)
 
 void cSVDRPServer::CmdLSTE(const char *Option)
 {
-  LOCK_CHANNELS_READ;
-  LOCK_SCHEDULES_READ;
-  const cSchedule* Schedule = NULL;
+  bool SingleSchedule = false;
+  tChannelID ChannelID;
   eDumpMode DumpMode = dmAll;
   time_t AtTime = 0;
   if (*Option) {
+     LOCK_CHANNELS_READ;
+     LOCK_SCHEDULES_READ;
+     const cSchedule* Schedule = NULL;
      char buf[strlen(Option) + 1];
      strcpy(buf, Option);
      const char *delim = " \t";
@@ -1677,26 +1786,60 @@ void cSVDRPServer::CmdLSTE(const char *Option)
               }
            p = strtok_r(NULL, delim, &strtok_next);
            }
-     }
-  int fd = dup(file);
-  if (fd) {
-     FILE *f = fdopen(fd, "w");
-     if (f) {
-        if (Schedule)
+     if (Schedule) {
+        SingleSchedule = true;
+        ChannelID = Schedule->ChannelID();
+        }
+     }
+  if (FILE *f = OpenOutput()) {
+     // The schedules are dumped one at a time, and the locks are released while waiting
+     // for the client to take the data, so that a slow client doesn't hold up EPG processing:
+     // Since the channels and schedules may change in the meantime, the schedules are dumped
+     // in the order of their channels, and we remember the id of the channel that has been
+     // dumped last and continue with the one following it:
+     bool First = true;
+     bool Lost = false;
+     for (;;) {
+         {
+           LOCK_CHANNELS_READ;
+           LOCK_SCHEDULES_READ;
+           const cSchedule *Schedule = NULL;
+           if (SingleSchedule)
+              Schedule = First ? Schedules->GetSchedule(ChannelID) : NULL;
+           else {
+              const cChannel *Channel = First ? Channels->First() : Channels->GetByChannelID(ChannelID);
+              if (!Channel) {
+                 Lost = !First;
+                 break;
+                 }
+              if (!First)
+                 Channel = Channels->Next(Channel);
+              for (; Channel; Channel = Channels->Next(Channel)) {
+                  // Channels with the same id share the same schedule, which is only dumped once:
+                  if (!Channel->GroupSep() && Channels->GetByChannelID(Channel->GetChannelID()) == Channel) {
+                     if ((Schedule = Schedules->GetSchedule(Channel)) != NULL) {
+                        ChannelID = Channel->GetChannelID();
+                        break;
+                        }
+                     }
+                  }
+              }
+           if (!Schedule)
+              break;
            Schedule->Dump(Channels, f, "215-", DumpMode, AtTime);
-        else
-           Schedules->Dump(f, "215-", DumpMode, AtTime);
-        fflush(f);
+           fflush(f);
+           First = false;
+         }
+         WaitForOutput();
+         }
+     fclose(f);
+     if (Lost)
+        Reply(451, "Channels changed while listing EPG data");
+     else
         Reply(215, "End of EPG data");
-        fclose(f);
-        }
-     else {
-        Reply(451, "Can't open file connection");
-        close(fd);
-        }
      }
   else
-     Reply(451, "Can't dup stream descriptor");
+     Reply(451, "Can't open file connection");
 }
 
 void cSVDRPServer::CmdLSTR(const char *Option)
@@ -1729,16 +1872,12 @@ void cSVDRPServer::CmdLSTR(const char *Option)
            }
      if (Number) {
         if (const cRecording *Recording = Recordings->GetById(strtol(Option, NULL, 10))) {
-           FILE *f = fdopen(file, "w");
-           if (f) {
-              if (Path)
-                 Reply(250, "%s", Recording->FileName());
-              else {
-                 Recording->Info()->Write(f, "215-");
-                 fflush(f);
-                 Reply(215, "End of recording information");
-                 }
-              // don't 'fclose(f)' here!
+           if (Path)
+              Reply(250, "%s", Recording->FileName());
+           else if (FILE *f = OpenOutput()) {
+              Recording->Info()->Write(f, "215-");
+              fclose(f);
+              Reply(215, "End of recording information");
               }
            else
               Reply(451, "Can't open file connection");
@@ -2338,10 +2477,22 @@ void cSVDRPServer::CmdVOLU(const char *Option)
 
 #define CMD(c) (strcasecmp(Cmd, c) == 0)
 
+static bool SVDRPReadOnlyCommand(const char *Cmd)
+{
+  // Returns true if Cmd only reads data, so that it can be executed in parallel to other commands:
+  static const char *ReadOnlyCommands[] = { "LSTC", "LSTE", "LSTR", "LSTT", "NEXT", "PING", "STAT", NULL };
+  for (const char **c = ReadOnlyCommands; *c; c++) {
+      if (strcasecmp(Cmd, *c) == 0)
+         return true;
+      }
+  return false;
+}
+
 void cSVDRPServer::Execute(char *Cmd)
 {
   // handle PUTE data:
   if (PUTEhandler) {
+     cMutexLock MutexLock(&SVDRPExecuteMutex);
      if (!PUTEhandler->Process(Cmd)) {
         Reply(PUTEhandler->Status(), "%s", PUTEhandler->Message());
         DELETENULL(PUTEhandler);
@@ -2358,6 +2509,7 @@ void cSVDRPServer::Execute(char *Cmd)
   if (*s)
      *s++ = 0;
   s = skipspace(s);
+  cMutexLock MutexLock(SVDRPReadOnlyCommand(Cmd) ? NULL : &SVDRPExecuteMutex);
   if      (CMD("CHAN"))  CmdCHAN(s);
   else if (CMD("CLRE"))  CmdCLRE(s);
   else if (CMD("DELC"))  CmdDELC(s);
@@ -2394,69 +2546,121 @@ void cSVDRPServer::Execute(char *Cmd)
   else                   Reply(500, "Command unrecognized: \"%s\"", Cmd);
 }
 
+void cSVDRPServer::Receive(const uchar *Data, int Length)
+{
+  for (int i = 0; i < Length; i++) {
+      uchar c = Data[i];
+      if (c == '\n' || c == 0x00) {
+         // strip trailing whitespace:
+         while (numChars > 0 && strchr(" \t\r\n", cmdLine[numChars - 1]))
+               cmdLine[--numChars] = 0;
+         // make sure the string is terminated:
+         cmdLine[numChars] = 0;
+         // queue it for execution:
+         commands.Append(strdup(cmdLine));
+         numChars = 0;
+         if (length > BUFSIZ) {
+            free(cmdLine); // let's not tie up too much memory
+            length = BUFSIZ;
+            cmdLine = MALLOC(char, length);
+            }
+         }
+      else if (c == 0x04 && numChars == 0) {
+         // end of file (only at beginning of line)
+         commands.Append(strdup("QUIT")); // executed after any commands that are still pending
+         }
+      else if (c == 0x08 || c == 0x7F) {
+         // backspace or delete (last character)
+         if (numChars > 0)
+            numChars--;
+         }
+      else if (c <= 0x03 || c == 0x0D) {
+         // ignore control characters
+         }
+      else {
+         if (numChars >= length - 1) {
+            int NewLength = length + BUFSIZ;
+            if (char *NewBuffer = (char *)realloc(cmdLine, NewLength)) {
+               length = NewLength;
+               cmdLine = NewBuffer;
+               }
+            else {
+               esyslog("SVDRP < %s ERROR: out of memory", *connection);
+               Disconnect();
+               break;
+               }
+            }
+         cmdLine[numChars++] = c;
+         cmdLine[numChars] = 0;
+         }
+      }
+}
+
+void cSVDRPServer::AddToPoller(cPoller &Poller)
+{
+  cMutexLock MutexLock(&mutex);
+  if (file.IsOpen()) {
+     if (!closing && commands.Size() < SVDRPMAXCOMMANDS && output.Length() - outputOffset < SVDRPMAXOUTPUT)
+        Poller.Add(file, false);
+     if (output.Length() > outputOffset)
+        Poller.Add(file, true);
+     }
+}
+
+bool cSVDRPServer::StartCommand(void)
+{
+  cMutexLock MutexLock(&mutex);
+  if (file.IsOpen() && !busy && !closing && commands.Size() && output.Length() - outputOffset <= SVDRPMAXOUTPUT) {
+     busy = true;
+     return true;
+     }
+  return false;
+}
+
+void cSVDRPServer::ExecuteCommand(void)
+{
+  mutex.Lock();
+  char *Cmd = commands.Size() ? commands[0] : NULL;
+  if (Cmd)
+     commands.Remove(0);
+  mutex.Unlock();
+  if (Cmd) {
+     Execute(Cmd);
+     free(Cmd);
+     }
+  mutex.Lock();
+  busy = false;
+  mutex.Unlock();
+  WakeupSVDRPServerHandler();
+}
+
 bool cSVDRPServer::Process(void)
 {
+  cMutexLock MutexLock(&mutex);
   if (file.IsOpen()) {
-     while (file.Ready(false)) {
-           unsigned char c;
-           int r = safe_read(file, &c, 1);
-           if (r > 0) {
-              if (c == '\n' || c == 0x00) {
-                 // strip trailing whitespace:
-                 while (numChars > 0 && strchr(" \t\r\n", cmdLine[numChars - 1]))
-                       cmdLine[--numChars] = 0;
-                 // make sure the string is terminated:
-                 cmdLine[numChars] = 0;
-                 // showtime!
-                 Execute(cmdLine);
-                 numChars = 0;
-                 if (length > BUFSIZ) {
-                    free(cmdLine); // let's not tie up too much memory
-                    length = BUFSIZ;
-                    cmdLine = MALLOC(char, length);
-                    }
-                 }
-              else if (c == 0x04 && numChars == 0) {
-                 // end of file (only at beginning of line)
-                 Close(true);
-                 }
-              else if (c == 0x08 || c == 0x7F) {
-                 // backspace or delete (last character)
-                 if (numChars > 0)
-                    numChars--;
-                 }
-              else if (c <= 0x03 || c == 0x0D) {
-                 // ignore control characters
-                 }
-              else {
-                 if (numChars >= length - 1) {
-                    int NewLength = length + BUFSIZ;
-                    if (char *NewBuffer = (char *)realloc(cmdLine, NewLength)) {
-                       length = NewLength;
-                       cmdLine = NewBuffer;
-                       }
-                    else {
-                       esyslog("SVDRP < %s ERROR: out of memory", *connection);
-                       Close();
-                       break;
-                       }
-                    }
-                 cmdLine[numChars++] = c;
-                 cmdLine[numChars] = 0;
-                 }
-              lastActivity = time(NULL);
-              }
-           else if (r <= 0) {
-              isyslog("SVDRP < %s lost connection to client", *connection);
-              Close();
-              }
+     // Read whatever input is available, but only as long as it can be handled:
+     if (!closing && commands.Size() < SVDRPMAXCOMMANDS && output.Length() - outputOffset < SVDRPMAXOUTPUT) {
+        uchar b[SVDRPREADSIZE];
+        int r = recv(file, b, sizeof(b), MSG_DONTWAIT);
+        if (r > 0) {
+           Receive(b, r);
+           lastActivity = time(NULL);
+           }
+        else if (r == 0 || FATALERRNO) {
+           isyslog("SVDRP < %s lost connection to client", *connection);
+           Disconnect();
            }
-     if (Setup.SVDRPTimeout && time(NULL) - lastActivity > Setup.SVDRPTimeout) {
+        }
+     if (!Flush())
+        Disconnect();
+     else if (closing && output.Length() == outputOffset)
+        Disconnect();
+     else if (Setup.SVDRPTimeout && !busy && !commands.Size() && time(NULL) - lastActivity > Setup.SVDRPTimeout) {
         isyslog("SVDRP < %s timeout on connection", *connection);
         Close(true, true);
         }
      }
-  return file.IsOpen();
+  return file.IsOpen() || busy;
 }
 
 void SetSVDRPPorts(int TcpPort, int UdpPort)
@@ -2472,22 +2676,63 @@ void SetSVDRPGrabImageDir(const char *GrabImageDir)
 
 // --- cSVDRPServerHandler ---------------------------------------------------
 
+class cSVDRPServerHandler;
+
+class cSVDRPWorker : public cThread {
+private:
+  cSVDRPServerHandler *handler;
+protected:
+  virtual void Action(void);
+public:
+  cSVDRPWorker(cSVDRPServerHandler *Handler);
+  virtual ~cSVDRPWorker();
+  void Stop(void) { Cancel(-1); }
+  };
+
 class cSVDRPServerHandler : public cThread {
 private:
   cMutex mutex;
   bool ready;
   cSocket tcpSocket;
   cVector<cSVDRPServer *> serverConnections;
+  cMutex workMutex;
+  cCondVar workAvailable;
+  cVector<cSVDRPServer *> work; // connections with a command that waits for a worker
+  cVector<cSVDRPWorker *> workers;
+  int idleWorkers;
   void HandleServerConnection(void);
   void ProcessConnections(void);
+  void StartCommands(void);
 protected:
   virtual void Action(void);
 public:
   cSVDRPServerHandler(int TcpPort);
   virtual ~cSVDRPServerHandler();
   void WaitUntilReady(void);
+  cSVDRPServer *GetWork(int TimeoutMs);
+       ///< Returns a connection the next command of which shall be executed,
+       ///< or NULL if there is none within the given timeout.
   };
 
+cSVDRPWorker::cSVDRPWorker(cSVDRPServerHandler *Handler)
+:cThread("SVDRP worker", true)
+{
+  handler = Handler;
+}
+
+cSVDRPWorker::~cSVDRPWorker()
+{
+  Cancel(3);
+}
+
+void cSVDRPWorker::Action(void)
+{
+  while (Running()) {
+        if (cSVDRPServer *Server = handler->GetWork(1000))
+           Server->ExecuteCommand();
+        }
+}
+
 static cSVDRPServerHandler *SVDRPServerHandler = NULL;
 
 cSVDRPServerHandler::cSVDRPServerHandler(int TcpPort)
@@ -2495,13 +2740,64 @@ cSVDRPServerHandler::cSVDRPServerHandler(int TcpPort)
 ,tcpSocket(TcpPort, true)
 {
   ready = false;
+  idleWorkers = 0;
+  if (pipe2(SVDRPServerWakeupPipe, O_NONBLOCK) < 0)
+     LOG_ERROR;
 }
 
 cSVDRPServerHandler::~cSVDRPServerHandler()
 {
   Cancel(3);
+  // Make sure no worker is stuck waiting for output to be sent:
+  for (int i = 0; i < serverConnections.Size(); i++)
+      serverConnections[i]->Abort();
+  for (int i = 0; i < workers.Size(); i++)
+      workers[i]->Stop();
+  workMutex.Lock();
+  workAvailable.Broadcast();
+  workMutex.Unlock();
+  for (int i = 0; i < workers.Size(); i++)
+      delete workers[i];
   for (int i = 0; i < serverConnections.Size(); i++)
       delete serverConnections[i];
+  close(SVDRPServerWakeupPipe[0]);
+  close(SVDRPServerWakeupPipe[1]);
+  SVDRPServerWakeupPipe[0] = SVDRPServerWakeupPipe[1] = -1;
+}
+
+cSVDRPServer *cSVDRPServerHandler::GetWork(int TimeoutMs)
+{
+  cMutexLock MutexLock(&workMutex);
+  if (!work.Size()) {
+     idleWorkers++;
+     workAvailable.TimedWait(workMutex, TimeoutMs);
+     idleWorkers--;
+     }
+  if (work.Size()) {
+     cSVDRPServer *Server = work[0];
+     work.Remove(0);
+     return Server;
+     }
+  return NULL;
+}
+
+void cSVDRPServerHandler::StartCommands(void)
+{
+  // Hands the next command of each connection to a worker (commands of the same
+  // connection are executed one after the other, in the order they were received):
+  cMutexLock MutexLock(&workMutex);
+  for (int i = 0; i < serverConnections.Size(); i++) {
+      if (serverConnections[i]->StartCommand())
+         work.Append(serverConnections[i]);
+      }
+  if (work.Size()) {
+     for (int n = work.Size() - idleWorkers; n > 0 && workers.Size() < SVDRPMAXWORKERS; n--) {
+         cSVDRPWorker *Worker = new cSVDRPWorker(this);
+         workers.Append(Worker);
+         Worker->Start();
+         }
+     workAvailable.Broadcast();
+     }
 }
 
 void cSVDRPServerHandler::WaitUntilReady(void)
@@ -2533,15 +2829,23 @@ void cSVDRPServerHandler::HandleServerConnection(void)
 void cSVDRPServerHandler::Action(void)
 {
   if (tcpSocket.Listen()) {
-     SVDRPServerPoller.Add(tcpSocket.Socket(), false);
      ready = true;
      while (Running()) {
-           SVDRPServerPoller.Poll(1000);
+           cPoller Poller(tcpSocket.Socket());
+           Poller.Add(SVDRPServerWakeupPipe[0], false);
+           mutex.Lock();
+           for (int i = 0; i < serverConnections.Size(); i++)
+               serverConnections[i]->AddToPoller(Poller);
+           mutex.Unlock();
+           Poller.Poll(1000);
+           char b[64];
+           while (read(SVDRPServerWakeupPipe[0], b, sizeof(b)) > 0)
+                 ;
            cMutexLock MutexLock(&mutex);
            HandleServerConnection();
            ProcessConnections();
+           StartCommands();
            }
-     SVDRPServerPoller.Del(tcpSocket.Socket(), false);
      tcpSocket.Close();
      }
 }
@@ -21,6 +21,23 @@
 // format characters in order to allow any number of blanks after a numeric
 // value!
 
+// Incremented whenever a timer is added to or deleted from a list, or gets
+// a new channel, to know when cTimers::channelIndex needs to be rebuilt:
+static cMutex TimerChannelMutex;
+static int TimerChannelChanges = 0;
+
+static void TimerChannelChanged(void)
+{
+  cMutexLock MutexLock(&TimerChannelMutex);
+  TimerChannelChanges++;
+}
+
+static int TimerChannelState(void)
+{
+  cMutexLock MutexLock(&TimerChannelMutex);
+  return TimerChannelChanges;
+}
+
 // --- cTimer ----------------------------------------------------------------
 
 cTimer::cTimer(bool Instant, bool Pause, const cChannel *Channel)
@@ -28,6 +45,7 @@ cTimer::cTimer(bool Instant, bool Pause, const cChannel *Channel)
   id = 0;
   startTime = stopTime = 0;
   scheduleState = -1;
+  frameBegin = frameEnd = 0;
   deferred = 0;
   pending = inVpsMargin = false;
   flags = tfNone;
@@ -86,6 +104,7 @@ cTimer::cTimer(const cEvent *Event)
   id = 0;
   startTime = stopTime = 0;
   scheduleState = -1;
+  frameBegin = frameEnd = 0;
   deferred = 0;
   pending = inVpsMargin = false;
   flags = tfActive;
@@ -145,6 +164,8 @@ cTimer& cTimer::operator= (const cTimer &Timer)
      startTime    = Timer.startTime;
      stopTime     = Timer.stopTime;
      scheduleState = -1;
+     frameBegin   = frameEnd = 0;
+     TimerChannelChanged();
      deferred     = 0;
      pending      = Timer.pending;
      inVpsMargin  = Timer.inVpsMargin;
@@ -343,6 +364,8 @@ bool cTimer::Parse(const char *s)
         esyslog("ERROR: channel %s not defined", channelbuffer);
         result = false;
         }
+     scheduleState = -1; // the channel may have changed
+     TimerChannelChanged();
      }
   free(channelbuffer);
   free(daybuffer);
@@ -533,10 +556,10 @@ bool cTimer::SetEventFromSchedule(const cSchedules *Schedules)
 {
   const cSchedule *Schedule = Schedules->GetSchedule(Channel());
   if (Schedule && Schedule->Events()->First()) {
-     if (Schedule->Modified(scheduleState)) {
-        const cEvent *Event = NULL;
-        if (HasFlags(tfVps) && Schedule->Events()->First()->Vps()) {
+     if (HasFlags(tfVps) && Schedule->Events()->First()->Vps()) {
+        if (Schedule->Modified(scheduleState)) {
            // VPS timers only match if their start time exactly matches the event's VPS time:
+           const cEvent *Event = NULL;
            for (const cEvent *e = Schedule->Events()->First(); e; e = Schedule->Events()->Next(e)) {
                if (e->StartTime() && e->RunningStatus() != SI::RunningStatusNotRunning) { // skip outdated events
                   int overlap = 0;
@@ -547,17 +570,30 @@ bool cTimer::SetEventFromSchedule(const cSchedules *Schedules)
                      }
                   }
                }
+           return SetEvent(Event);
            }
-        else {
+        }
+     else {
+        // Set up the time frame within which to check events:
+        Matches(0, true);
+        time_t TimeFrameBegin = StartTime() - EPGLIMITBEFORE;
+        time_t TimeFrameEnd   = StopTime()  + EPGLIMITAFTER;
+        bool Modified = true;
+        if (TimeFrameBegin == frameBegin && TimeFrameEnd == frameEnd) {
+           // Only changes to events that overlap the time frame (possibly before they
+           // have been moved out of it) can make a difference for this timer:
+           int MaxDuration = Schedule->MaxDuration();
+           Modified = Schedule->Modified(scheduleState, TimeFrameBegin - MaxDuration, TimeFrameEnd + MaxDuration);
+           }
+        else
+           Schedule->Modified(scheduleState); // to get the current state
+        if (Modified) {
            // Normal timers match the event they have the most overlap with:
+           const cEvent *Event = NULL;
            int Overlap = 0;
-           // Set up the time frame within which to check events:
-           Matches(0, true);
-           time_t TimeFrameBegin = StartTime() - EPGLIMITBEFORE;
-           time_t TimeFrameEnd   = StopTime()  + EPGLIMITAFTER;
-           for (const cEvent *e = Schedule->Events()->First(); e; e = Schedule->Events()->Next(e)) {
-               if (e->EndTime() < TimeFrameBegin)
-                  continue; // skip events way before the timer starts
+           frameBegin = TimeFrameBegin;
+           frameEnd = TimeFrameEnd;
+           for (const cEvent *e = Schedule->GetEventEndingAfter(TimeFrameBegin - 1); e; e = Schedule->Events()->Next(e)) { // skips events way before the timer starts
                if (e->StartTime() > TimeFrameEnd)
                   break; // the rest is way after the timer ends
                int overlap = 0;
@@ -569,8 +605,8 @@ bool cTimer::SetEventFromSchedule(const cSchedules *Schedules)
                   Event = e;
                   }
                }
+           return SetEvent(Event);
            }
-        return SetEvent(Event);
         }
      }
   return false;
@@ -717,6 +753,8 @@ cTimers::cTimers(void)
 :cConfig<cTimer>("1 Timers")
 {
   lastDeleteExpired = 0;
+  channelIndexState = -1;
+  channelIdState = -1;
 }
 
 bool cTimers::Load(const char *FileName)
@@ -786,11 +824,76 @@ const cTimer *cTimers::GetMatch(time_t t) const
   return t0;
 }
 
+static int CompareChannelIDs(const tChannelID &a, const tChannelID &b)
+{
+  if (a.Source() != b.Source())
+     return a.Source() < b.Source() ? -1 : 1;
+  if (a.Nid() != b.Nid())
+     return a.Nid() < b.Nid() ? -1 : 1;
+  if (a.Tid() != b.Tid())
+     return a.Tid() < b.Tid() ? -1 : 1;
+  if (a.Sid() != b.Sid())
+     return a.Sid() < b.Sid() ? -1 : 1;
+  if (a.Rid() != b.Rid())
+     return a.Rid() < b.Rid() ? -1 : 1;
+  return 0;
+}
+
+tTimerChannelIndex::tTimerChannelIndex(const cTimer *Timer, int Position)
+{
+  if (Timer)
+     channelID = Timer->Channel()->GetChannelID();
+  position = Position;
+  timer = Timer;
+}
+
+static int CompareTimerChannelIndex(const void *a, const void *b)
+{
+  const tTimerChannelIndex *ia = (const tTimerChannelIndex *)a;
+  const tTimerChannelIndex *ib = (const tTimerChannelIndex *)b;
+  if (int r = CompareChannelIDs(ia->channelID, ib->channelID))
+     return r;
+  return ia->position - ib->position; // timers on the same channel stay in list order
+}
+
+void cTimers::UpdateChannelIndex(void) const
+{
+  // The index needs to be rebuilt if any timer has been added, deleted or given a
+  // different channel, or if the ID of any channel has changed:
+  int State = TimerChannelState();
+  int IdState = cChannel::IdChanges();
+  if (channelIndexState != State || channelIdState != IdState) {
+     channelIndex.Clear();
+     int Position = 0;
+     for (const cTimer *ti = First(); ti; ti = Next(ti))
+         channelIndex.Append(tTimerChannelIndex(ti, Position++));
+     channelIndex.Sort(CompareTimerChannelIndex);
+     channelIndexState = State;
+     channelIdState = IdState;
+     }
+}
+
 const cTimer *cTimers::GetMatch(const cEvent *Event, eTimerMatch *Match) const
 {
   const cTimer *t = NULL;
   eTimerMatch m = tmNone;
-  for (const cTimer *ti = First(); ti; ti = Next(ti)) {
+  tChannelID ChannelID = Event->ChannelID();
+  cMutexLock MutexLock(&channelIndexMutex);
+  UpdateChannelIndex();
+  // Only timers on the event's channel can match it, so we look up the first one of these:
+  int Lo = 0;
+  int Hi = channelIndex.Size();
+  while (Lo < Hi) {
+        int i = (Lo + Hi) / 2;
+        if (CompareChannelIDs(channelIndex[i].channelID, ChannelID) < 0)
+           Lo = i + 1;
+        else
+           Hi = i;
+        }
+  for (int i = Lo; i < channelIndex.Size(); i++) {
+      if (!(channelIndex[i].channelID == ChannelID))
+         break;
+      const cTimer *ti = channelIndex[i].timer;
       eTimerMatch tm = ti->Matches(Event);
       if (tm > m) {
          t = ti;
@@ -832,12 +935,14 @@ void cTimers::Add(cTimer *Timer, cTimer *After)
   if (!Timer->Remote())
      Timer->SetId(NewTimerId());
   cConfig<cTimer>::Add(Timer, After);
+  TimerChannelChanged();
   cStatus::MsgTimerChange(Timer, tcAdd);
 }
 
 void cTimers::Ins(cTimer *Timer, cTimer *Before)
 {
   cConfig<cTimer>::Ins(Timer, Before);
+  TimerChannelChanged();
   cStatus::MsgTimerChange(Timer, tcAdd);
 }
 
@@ -845,6 +950,7 @@ void cTimers::Del(cTimer *Timer, bool DeleteObject)
 {
   cStatus::MsgTimerChange(Timer, tcDel);
   cConfig<cTimer>::Del(Timer, DeleteObject);
+  TimerChannelChanged();
 }
 
 const cTimer *cTimers::UsesChannel(const cChannel *Channel) const
@@ -30,6 +30,7 @@ private:
   int id;
   mutable time_t startTime, stopTime;
   int scheduleState;
+  time_t frameBegin, frameEnd; ///< the time frame within which the event has last been looked up
   mutable time_t deferred; ///< Matches(time_t, ...) will return false if the current time is before this value
   bool pending, inVpsMargin;
   uint flags;
@@ -113,11 +114,23 @@ public:
   static cString PrintDay(time_t Day, int WeekDays, bool SingleByteChars);
   };
 
+struct tTimerChannelIndex {
+  tChannelID channelID; ///< the channel ID of the timer at the time the index was built
+  int position;         ///< the position of the timer in the list
+  const cTimer *timer;
+  tTimerChannelIndex(const cTimer *Timer, int Position = 0);
+  };
+
 class cTimers : public cConfig<cTimer> {
 private:
   static cTimers timers;
   static int lastTimerId;
   time_t lastDeleteExpired;
+  mutable cMutex channelIndexMutex;
+  mutable cVector<tTimerChannelIndex> channelIndex; ///< all timers, sorted by channel (and in list order within a channel)
+  mutable int channelIndexState;
+  mutable int channelIdState;
+  void UpdateChannelIndex(void) const;
 public:
   cTimers(void);
   static const cTimers *GetTimersRead(cStateKey &StateKey, int TimeoutMs = 0);
@@ -1760,6 +1760,16 @@ bool cSafeFile::Close(void)
   return result;
 }
 
+void cSafeFile::Discard(void)
+{
+  if (f) {
+     fclose(f);
+     f = NULL;
+     }
+  if (tempName)
+     unlink(tempName);
+}
+
 // --- cUnbufferedFile -------------------------------------------------------
 
 #define USE_FADVISE
@@ -1895,53 +1905,88 @@ ssize_t cUnbufferedFile::Read(void *Data, size_t Size)
   return -1;
 }
 
+void cUnbufferedFile::Written(ssize_t BytesWritten)
+{
+#ifdef USE_FADVISE
+  if (BytesWritten > 0) {
+     begin = min(begin, curpos);
+     curpos += BytesWritten;
+     written += BytesWritten;
+     lastpos = max(lastpos, curpos);
+     if (written > WRITE_BUFFER) {
+        if (lastpos > begin) {
+           // Now do three things:
+           // 1) Start writeback of begin..lastpos range
+           // 2) Drop the already written range (by the previous fadvise call)
+           // 3) Handle nonpagealigned data.
+           //    This is why we double the WRITE_BUFFER; the first time around the
+           //    last (partial) page might be skipped, writeback will start only after
+           //    second call; the third call will still include this page and finally
+           //    drop it from cache.
+           off_t headdrop = min(begin, off_t(WRITE_BUFFER * 2));
+           posix_fadvise(fd, begin - headdrop, lastpos - begin + headdrop, POSIX_FADV_DONTNEED);
+           }
+        begin = lastpos = curpos;
+        totwritten += written;
+        written = 0;
+        // The above fadvise() works when writing slowly (recording), but could
+        // leave cached data around when writing at a high rate, e.g. when cutting,
+        // because by the time we try to flush the cached pages (above) the data
+        // can still be dirty - we are faster than the disk I/O.
+        // So we do another round of flushing, just like above, but at larger
+        // intervals -- this should catch any pages that couldn't be released
+        // earlier.
+        if (totwritten > MEGABYTE(32)) {
+           // It seems in some setups, fadvise() does not trigger any I/O and
+           // a fdatasync() call would be required do all the work (reiserfs with some
+           // kind of write gathering enabled), but the syncs cause (io) load..
+           // Uncomment the next line if you think you need them.
+           //fdatasync(fd);
+           off_t headdrop = min(off_t(curpos - totwritten), off_t(totwritten * 2));
+           posix_fadvise(fd, curpos - totwritten - headdrop, totwritten + headdrop, POSIX_FADV_DONTNEED);
+           totwritten = 0;
+           }
+        }
+     }
+#endif
+}
+
 ssize_t cUnbufferedFile::Write(const void *Data, size_t Size)
 {
   if (fd >=0) {
      ssize_t bytesWritten = safe_write(fd, Data, Size);
-#ifdef USE_FADVISE
-     if (bytesWritten > 0) {
-        begin = min(begin, curpos);
-        curpos += bytesWritten;
-        written += bytesWritten;
-        lastpos = max(lastpos, curpos);
-        if (written > WRITE_BUFFER) {
-           if (lastpos > begin) {
-              // Now do three things:
-              // 1) Start writeback of begin..lastpos range
-              // 2) Drop the already written range (by the previous fadvise call)
-              // 3) Handle nonpagealigned data.
-              //    This is why we double the WRITE_BUFFER; the first time around the
-              //    last (partial) page might be skipped, writeback will start only after
-              //    second call; the third call will still include this page and finally
-              //    drop it from cache.
-              off_t headdrop = min(begin, off_t(WRITE_BUFFER * 2));
-              posix_fadvise(fd, begin - headdrop, lastpos - begin + headdrop, POSIX_FADV_DONTNEED);
-              }
-           begin = lastpos = curpos;
-           totwritten += written;
-           written = 0;
-           // The above fadvise() works when writing slowly (recording), but could
-           // leave cached data around when writing at a high rate, e.g. when cutting,
-           // because by the time we try to flush the cached pages (above) the data
-           // can still be dirty - we are faster than the disk I/O.
-           // So we do another round of flushing, just like above, but at larger
-           // intervals -- this should catch any pages that couldn't be released
-           // earlier.
-           if (totwritten > MEGABYTE(32)) {
-              // It seems in some setups, fadvise() does not trigger any I/O and
-              // a fdatasync() call would be required do all the work (reiserfs with some
-              // kind of write gathering enabled), but the syncs cause (io) load..
-              // Uncomment the next line if you think you need them.
-              //fdatasync(fd);
-              off_t headdrop = min(off_t(curpos - totwritten), off_t(totwritten * 2));
-              posix_fadvise(fd, curpos - totwritten - headdrop, totwritten + headdrop, POSIX_FADV_DONTNEED);
-              totwritten = 0;
+     Written(bytesWritten);
+     return bytesWritten;
+     }
+  return -1;
+}
+
+ssize_t cUnbufferedFile::CopyRange(cUnbufferedFile *From, off_t Offset, size_t Size)
+{
+  if (fd >= 0 && From->fd >= 0) {
+#if __GLIBC_PREREQ(2, 27)
+     ssize_t bytesCopied = 0;
+     while (Size > 0) {
+           loff_t off = Offset;
+           ssize_t r = copy_file_range(From->fd, &off, fd, NULL, Size, 0);
+           if (r < 0) {
+              if (errno == EINTR)
+                 continue;
+              if (bytesCopied)
+                 break;
+              return -1;
               }
+           if (r == 0)
+              break; // end of file
+           Written(r);
+           bytesCopied += r;
+           Offset += r;
+           Size -= r;
            }
-        }
+     return bytesCopied;
+#else
+     errno = ENOSYS;
 #endif
-     return bytesWritten;
      }
   return -1;
 }
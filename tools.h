@@ -443,6 +443,9 @@ public:
   operator FILE* () { return f; }
   bool Open(void);
   bool Close(void);
+  void Discard(void);
+       ///< Closes and removes the temporary file without replacing the original one.
+       ///< This is used if writing the data failed.
   };
 
 /// cUnbufferedFile is used for large files that are mainly written or read
@@ -461,6 +464,7 @@ private:
   size_t written;
   size_t totwritten;
   int FadviseDrop(off_t Offset, off_t Len);
+  void Written(ssize_t BytesWritten);
 public:
   cUnbufferedFile(void);
   ~cUnbufferedFile();
@@ -470,6 +474,15 @@ public:
   off_t Seek(off_t Offset, int Whence);
   ssize_t Read(void *Data, size_t Size);
   ssize_t Write(const void *Data, size_t Size);
+  ssize_t CopyRange(cUnbufferedFile *From, off_t Offset, size_t Size);
+       ///< Copies Size bytes, starting at Offset in From, to the current position
+       ///< of this file, without passing them through user space. The current
+       ///< position of From is not changed.
+       ///< Returns the number of bytes actually copied (which may be less than Size
+       ///< if the end of From has been reached, or an error occurred after some
+       ///< data has already been copied), or -1 in case of an error. If errno is
+       ///< then ENOSYS, EXDEV, EINVAL or EOPNOTSUPP, the file systems involved don't
+       ///< support this, and the data needs to be copied with Read() and Write().
   static cUnbufferedFile *Create(const char *FileName, int Flags, mode_t Mode = DEFFILEMODE);
   };
 
@@ -773,6 +773,7 @@ int main(int argc, char *argv[])
 
   // Recordings:
 
+  cRecordings::SetCacheFileName(AddDirectory(CacheDirectory, "recordings.cache"));
   cRecordings::Update();
 
   // EPG data: